@@ -12,11 +12,57 @@
  *
  *               The driver handles the output ports as 16 channels.
  *               The state of the channels can be read.
+ *
+ *               The driver keeps a shadow of the output register, so
+ *               that channel updates need no read-modify-write cycle
+ *               on the M-Module bus. Reads are answered from the shadow
+ *               unless M27_READBACK is enabled.
+ *
+ *               A table of timed output words can be played back by the
+ *               driver (sequence engine, driven by an OSS alarm).
+ *               Channels can also be driven as slow software PWM outputs
+ *               (one cyclic OSS alarm for all PWM channels) or fire
+ *               single pulses and pulse trains.
+ *
+ *               Calls, register accesses and the time spent in each
+ *               entry point are counted (M27_BLK_STATS), also in
+ *               release builds.
+ *
+ *               Every change of the output register can be recorded with
+ *               timestamp and source in a ring buffer (M27_TRACE), which
+ *               is drained with M27_BLK_TRACE.
+ *
+ *               The driver serializes its callers itself (MDIS lock mode
+ *               LL_LOCK_NONE). By default every call takes the device
+ *               semaphore. With descriptor key LOCK_MODE=1, output
+ *               updates and reads run concurrently and are only
+ *               protected by the output spin lock. LOCK_MODE=2 locks
+ *               single channel reads/writes per channel.
+ *
+ *               Channel changes can be staged (M27_STAGE_MASKED) and
+ *               written with one register access by M27_COMMIT.
+ *
+ *               A list of output operations and delays can be executed
+ *               within one call (M27_BLK_CMDLIST).
+ *
+ *               Each change of the output register advances a generation
+ *               counter. M27_BLK_WAIT_CHANGE blocks until the generation
+ *               differs from a known one, so monitors need not poll.
+ *
+ *               The ID PROM is read completely at init and kept in the
+ *               handle, M_LL_BLK_ID_DATA doesn't access the PROM. The
+ *               time spent in the init phases is reported by
+ *               M27_BLK_INIT_TIME.
  *   
  *               The driver does not support buffers.
  *               
  *     Required: ---
  *     Switches: _ONE_NAMESPACE_PER_DRIVER_
+ *               M27_STATS_TIME(h)  time source for entry statistics,
+ *               M27_STATS_UNIT(h)  its unit [ns] (default: 1024 ns with
+ *                                  the Linux kernel clock, OSS ticks
+ *                                  otherwise), also used for trace
+ *                                  timestamps and the init time
  *
  *---------------------------------------------------------------------------
  * Copyright 1998-2019, MEN Mikro Elektronik GmbH
@@ -48,6 +94,9 @@
 #include <MEN/mdis_com.h>   /* MDIS common defs               */
 #include <MEN/mdis_err.h>   /* MDIS error codes               */
 #include <MEN/ll_defs.h>    /* low level driver definitions   */
+#if defined(LINUX) && defined(__KERNEL__) && !defined(M27_STATS_TIME)
+#	include <linux/ktime.h>	/* statistics time source         */
+#endif
 
 /*-----------------------------------------+
 |  DEFINES                                 |
@@ -62,6 +111,29 @@
 #define MOD_ID_1			27			/* id prom module id */
 #define MOD_ID_2			28			/* id prom module id */
 #define MOD_ID_3			81			/* id prom module id */
+#define PULSE_BUSY_MAX		1000		/* max. busy-waited pulse time [us] */
+#define PULSE_COUNT_MAX		0x7fffffff	/* max. nr of pulses (2 edges each) */
+#define CMD_SLEEP_MAX		1000		/* max. sleep time per cmd list [ms] */
+
+/* entry point classes (EntryLock) */
+#define ENTRY_STATUS		0			/* status call */
+#define ENTRY_OUTPUT		1			/* output update/read */
+#define ENTRY_CHANNEL		2			/* single channel read/write */
+
+/* entry statistics (see M27_STATS in m27_drv.h) */
+#define STATS_ENTRIES		6			/* nr of counted entry points */
+#define STATS_BUCKETS		16			/* nr of histogram buckets */
+
+#ifndef M27_STATS_TIME
+#	if defined(LINUX) && defined(__KERNEL__)
+		/* monotonic kernel clock, unit 1024 ns (buckets up to ~16 ms) */
+#		define M27_STATS_TIME(h)	((u_int32)(ktime_to_ns(ktime_get()) >> 10))
+#		define M27_STATS_UNIT(h)	1024							/* [ns] */
+#	else
+#		define M27_STATS_TIME(h)	OSS_TickGet((h)->osHdl)			/* [ticks] */
+#		define M27_STATS_UNIT(h)	(1000000000 / (h)->tickRate)	/* [ns] */
+#	endif
+#endif
 
 /* debug settings */
 #define DBG_MYLEVEL			llHdl->dbgLevel
@@ -87,12 +159,91 @@ typedef struct {
 	DBG_HANDLE      *dbgHdl;        /* debug handle */
 	/* misc */
     u_int32         idCheck;		/* id check enabled */
+	u_int16         idProm[MOD_ID_SIZE/2];	/* id prom words (read at init) */
+	/* init time [M27_STATS_UNIT] */
+	u_int32         initDesc;		/* descriptor parse */
+	u_int32         initIdCheck;	/* id prom read and check */
+	u_int32         initReset;		/* hardware reset */
+	u_int32         initTotal;		/* whole M27_Init */
+	/* output */
+	u_int16         outShadow;		/* shadow of OUTPUT_REG */
+	u_int32         readBack;		/* re-read OUTPUT_REG on read */
+	u_int32         outExit;		/* M27_OUTEXIT_xxx */
+	u_int16         stgMask;		/* staged channels */
+	u_int16         stgValue;		/* staged channel states */
+	u_int32         blkMode;		/* block i/o buffer layout */
+	u_int32         blkStart;		/* block i/o start channel */
+	OSS_SPINL_HANDLE *outLock;		/* protects shadow and OUTPUT_REG */
+	u_int32         outGen;			/* output generation (changes) */
+	u_int32         genWaiters;		/* waiters to signal on change */
+	OSS_SEM_HANDLE  *genSem;		/* signalled on output change */
+	u_int32         tickRate;		/* OSS ticks per second */
+	/* sequence engine */
+	OSS_ALARM_HANDLE *seqAlarm;		/* sequence alarm */
+	struct M27_SEQ_ENTRY *seqTbl;	/* sequence table */
+	u_int32         seqTblAlloc;	/* size allocated for the table */
+	u_int32         seqLen;			/* nr of table entries */
+	u_int32         seqIdx;			/* next entry to play */
+	u_int32         seqLoops;		/* loops to play (0=endless) */
+	u_int32         seqLoop;		/* current loop */
+	u_int32         seqRun;			/* sequence running */
+	u_int32         seqStartTick;	/* start time [ticks] */
+	u_int32         seqDeadline;	/* next step [ms since start] */
+	u_int32         seqSteps;		/* steps executed */
+	u_int32         seqLate;		/* steps played late */
+	/* software pwm */
+	OSS_ALARM_HANDLE *pwmAlarm;		/* pwm alarm */
+	u_int32         pwmTick;		/* requested pwm tick [ms] */
+	u_int32         pwmTickMs;		/* real pwm tick [ms] */
+	u_int16         pwmMask;		/* channels in pwm mode */
+	u_int16         pwmValue;		/* current pwm output states */
+	u_int32         pwmPeriodMs[CH_NUMBER];	/* period [ms] (0=off) */
+	u_int32         pwmDuty[CH_NUMBER];		/* duty cycle [1/1000] */
+	u_int32         pwmPeriod[CH_NUMBER];	/* period [pwm ticks] */
+	u_int32         pwmOn[CH_NUMBER];		/* on-time [pwm ticks] */
+	u_int32         pwmPhase[CH_NUMBER];	/* current phase [pwm ticks] */
+	u_int32         pwmStartTick;	/* pwm start time [ticks] */
+	u_int32         pwmTicks;		/* pwm ticks executed */
+	u_int32         pwmElapsed;		/* time since pwm start [ms] */
+	u_int32         pwmMaxLate;		/* max. tick delay [ms] */
+	u_int32         pwmLate;		/* ticks delayed > one OSS tick */
+	/* pulse generator */
+	OSS_ALARM_HANDLE *pulseAlarm;	/* pulse alarm */
+	u_int32         pulseRun;		/* pulse (train) active */
+	u_int16         pulseMask;		/* pulsed channels */
+	u_int32         pulseWidthMs;	/* pulse width [ms] */
+	u_int32         pulsePeriodMs;	/* pulse period [ms] */
+	u_int32         pulseEdges;		/* nr of edges (2 per pulse) */
+	u_int32         pulseEdge;		/* next edge */
+	u_int32         pulseStartTick;	/* first edge [ticks] */
+	/* entry statistics */
+	u_int32         statCalls[STATS_ENTRIES];	/* calls per entry */
+	u_int32         statHist[STATS_ENTRIES][STATS_BUCKETS]; /* duration */
+	u_int32         statRegReads;	/* OUTPUT_REG reads */
+	u_int32         statRegWrites;	/* OUTPUT_REG writes */
+	u_int32         statRedundant;	/* skipped writes (word unchanged) */
+	u_int32         statWaits;		/* M27_BLK_WAIT_CHANGE calls */
+	/* output trace */
+	struct M27_TRACE_ENTRY *trcBuf;	/* ring buffer (NULL=never enabled) */
+	u_int32         trcAlloc;		/* size allocated for the buffer */
+	u_int32         trcOn;			/* trace enabled */
+	u_int32         trcHead;		/* next entry to write */
+	u_int32         trcCount;		/* nr of entries in buffer */
+	u_int32         trcLost;		/* entries overwritten since drain */
+	/* locking */
+	u_int32         lockMode;		/* M27_LOCKMODE_xxx */
+	OSS_SEM_HANDLE  *devSem;		/* serializes calls */
+	OSS_SEM_HANDLE  *chSem[CH_NUMBER];	/* per channel (LOCK_MODE 2) */
 } LL_HANDLE;
 
 /* include files which need LL_HANDLE */
 #include <MEN/ll_entry.h>   /* low level driver jumptable  */
 #include <MEN/m27_drv.h>	/* M27 driver header file */
 
+#if (STATS_ENTRIES != M27_STATS_ENTRIES) || (STATS_BUCKETS != M27_STATS_BUCKETS)
+#	error "STATS_ENTRIES/STATS_BUCKETS don't match m27_drv.h"
+#endif
+
 static const char IdentString[]=MENT_XSTR(MAK_REVISION);
 
 /*-----------------------------------------+
@@ -100,6 +251,35 @@ static const char IdentString[]=MENT_XSTR(MAK_REVISION);
 +-----------------------------------------*/
 static char* Ident( void );
 static int32 Cleanup(LL_HANDLE *llHdl, int32 retCode);
+static void StatsEntry(LL_HANDLE *llHdl, u_int32 entry, u_int32 start);
+static int32 EntryLock(LL_HANDLE *llHdl, u_int32 entry, int32 ch,
+					   OSS_SEM_HANDLE **semP);
+static void EntryUnlock(LL_HANDLE *llHdl, OSS_SEM_HANDLE *sem);
+static void OutputUpdate(LL_HANDLE *llHdl, u_int16 src, u_int16 mask,
+						 u_int16 value, u_int16 toggle);
+static void OutputStage(LL_HANDLE *llHdl, u_int16 mask, u_int16 value);
+static void StageCommit(LL_HANDLE *llHdl, u_int32 commit);
+static u_int16 OutputGet(LL_HANDLE *llHdl);
+static int32 BlockChannels(LL_HANDLE *llHdl, int32 ch, int32 size,
+						   int32 *firstP);
+static void OutputWrite(LL_HANDLE *llHdl, u_int16 src, u_int16 value);
+static void OutputChanged(LL_HANDLE *llHdl);
+static int32 WaitChange(LL_HANDLE *llHdl, M_SG_BLOCK *blk);
+static int32 TraceEnable(LL_HANDLE *llHdl, u_int32 on);
+static void TraceDrain(LL_HANDLE *llHdl, M_SG_BLOCK *blk);
+static u_int32 TicksToMs(LL_HANDLE *llHdl, u_int32 ticks);
+static int32 SeqLoad(LL_HANDLE *llHdl, M_SG_BLOCK *blk);
+static int32 SeqStart(LL_HANDLE *llHdl);
+static void SeqStop(LL_HANDLE *llHdl);
+static void SeqAlarm(void *arg);
+static int32 PwmConfig(LL_HANDLE *llHdl, int32 ch, u_int32 periodMs,
+					   u_int32 duty);
+static void PwmStop(LL_HANDLE *llHdl);
+static void PwmAlarm(void *arg);
+static int32 PulseStart(LL_HANDLE *llHdl, M_SG_BLOCK *blk);
+static int32 CmdList(LL_HANDLE *llHdl, M_SG_BLOCK *blk);
+static void PulseStop(LL_HANDLE *llHdl);
+static void PulseAlarm(void *arg);
 
 static int32 M27_Init(DESC_SPEC *descSpec, OSS_HANDLE *osHdl,
                       MACCESS *ma, OSS_SEM_HANDLE *devSemHdl,
@@ -147,7 +327,13 @@ static int32 M27_Info(int32 infoType, ... );
  *
  *  Description:  Allocate and return ll handle, initialize hardware
  * 
- *                The function resets all channels.
+ *                The function resets all channels, unless OUTPUT_INIT
+ *                selects another initial output state.
+ *
+ *                All MOD_ID_SIZE/2 ID PROM words are read and kept in
+ *                the handle (also with ID_CHECK=0), so M_LL_BLK_ID_DATA
+ *                needs no PROM access later. With ID_CHECK=1, magic and
+ *                module id are checked.
  *
  *                The following descriptor keys are used:
  *
@@ -156,6 +342,39 @@ static int32 M27_Info(int32 infoType, ... );
  *                DEBUG_LEVEL_DESC      OSS_DBG_DEFAULT  see dbg.h
  *                DEBUG_LEVEL           OSS_DBG_DEFAULT  see dbg.h
  *                ID_CHECK              1                0..1 
+ *                PWM_TICK              1                1..1000 [ms]
+ *                LOCK_MODE             0                0..2
+ *                OUTPUT_INIT           0                0..2
+ *                INIT_VALUE            0x0000           0..0xffff
+ *                OUTPUT_EXIT           0                0..1
+ *
+ *                PWM_TICK defines the base tick of the software PWM. The
+ *                PWM periods and on-times are multiples of this tick
+ *                (rounded to the resolution of the OSS alarm).
+ *
+ *                LOCK_MODE selects how concurrent calls are serialized
+ *                (see M27_LOCKMODE_xxx in m27_drv.h):
+ *                0  every call takes the device semaphore (like MDIS
+ *                   LL_LOCK_CALL)
+ *                1  M27_Read/Write/BlockRead/BlockWrite and the mask
+ *                   setstat codes take no semaphore; the output word is
+ *                   updated under the output spin lock only. All other
+ *                   status calls are serialized as in mode 0.
+ *                2  M27_Read/Write are serialized per channel, so owners
+ *                   of different channels don't wait for each other
+ *                   (MDIS LL_LOCK_CHAN). All other calls are serialized
+ *                   as in mode 0, output updates are made safe by the
+ *                   output spin lock.
+ *
+ *                OUTPUT_INIT defines the output state after init (see
+ *                M27_OUTINIT_xxx in m27_drv.h):
+ *                0  all channels reset
+ *                1  the current output register is adopted (warm
+ *                   restart, nothing is written)
+ *                2  INIT_VALUE is written with one register access
+ *
+ *                OUTPUT_EXIT=1 leaves the outputs as they are on exit
+ *                (M27_OUTEXIT_LEAVE), default is to reset them.
  *
  *---------------------------------------------------------------------------
  *  Input......:  descSpec   pointer to descriptor data
@@ -178,8 +397,8 @@ int32 M27_Init(
 {
     LL_HANDLE *llHdl = NULL;
     u_int32 gotsize;
-    int32 error;
-    u_int32 value;
+    int32 error, ch, n;
+    u_int32 value, outInit, start, t;
 
     /*------------------------------+
     |  prepare the handle           |
@@ -220,6 +439,8 @@ int32 M27_Init(
     /*------------------------------+
     |  scan descriptor              |
     +------------------------------*/
+	start = t = M27_STATS_TIME(llHdl);
+
 	/* prepare access */
     if ((error = DESC_Init(descP, osHdl, &llHdl->descHdl)))
 		return( Cleanup(llHdl,error) );
@@ -244,12 +465,69 @@ int32 M27_Init(
 		error != ERR_DESC_KEY_NOTFOUND)
 		return( Cleanup(llHdl,error) );
 
+    /* PWM_TICK */
+    if ((error = DESC_GetUInt32(llHdl->descHdl, 1, 
+								&llHdl->pwmTick, "PWM_TICK")) &&
+		error != ERR_DESC_KEY_NOTFOUND)
+		return( Cleanup(llHdl,error) );
+
+	if ((llHdl->pwmTick < 1) || (llHdl->pwmTick > 1000))
+		return( Cleanup(llHdl,ERR_LL_ILL_PARAM) );
+
+    /* LOCK_MODE */
+    if ((error = DESC_GetUInt32(llHdl->descHdl, M27_LOCKMODE_CALL, 
+								&llHdl->lockMode, "LOCK_MODE")) &&
+		error != ERR_DESC_KEY_NOTFOUND)
+		return( Cleanup(llHdl,error) );
+
+	if (llHdl->lockMode > M27_LOCKMODE_CHAN)
+		return( Cleanup(llHdl,ERR_LL_ILL_PARAM) );
+
+    /* OUTPUT_INIT */
+    if ((error = DESC_GetUInt32(llHdl->descHdl, M27_OUTINIT_RESET, 
+								&outInit, "OUTPUT_INIT")) &&
+		error != ERR_DESC_KEY_NOTFOUND)
+		return( Cleanup(llHdl,error) );
+
+	if (outInit > M27_OUTINIT_VALUE)
+		return( Cleanup(llHdl,ERR_LL_ILL_PARAM) );
+
+    /* INIT_VALUE */
+    if ((error = DESC_GetUInt32(llHdl->descHdl, 0x0000, 
+								&value, "INIT_VALUE")) &&
+		error != ERR_DESC_KEY_NOTFOUND)
+		return( Cleanup(llHdl,error) );
+
+	if (value > 0xffff)
+		return( Cleanup(llHdl,ERR_LL_ILL_PARAM) );
+
+	if (outInit == M27_OUTINIT_RESET)
+		value = 0x0000;
+
+    /* OUTPUT_EXIT */
+    if ((error = DESC_GetUInt32(llHdl->descHdl, M27_OUTEXIT_RESET, 
+								&llHdl->outExit, "OUTPUT_EXIT")) &&
+		error != ERR_DESC_KEY_NOTFOUND)
+		return( Cleanup(llHdl,error) );
+
+	if (llHdl->outExit > M27_OUTEXIT_LEAVE)
+		return( Cleanup(llHdl,ERR_LL_ILL_PARAM) );
+
+	llHdl->initDesc = M27_STATS_TIME(llHdl) - t;
+
     /*------------------------------+
-    |  check module id              |
+    |  read id prom, check id       |
     +------------------------------*/
+	t = M27_STATS_TIME(llHdl);
+
+	for (n=0; n<MOD_ID_SIZE/2; n++)
+		llHdl->idProm[n] = (u_int16)m_read((U_INT32_OR_64)llHdl->ma, n);
+
 	if (llHdl->idCheck) {
-		int modIdMagic = m_read((U_INT32_OR_64)llHdl->ma, 0);
-		int modId      = m_read((U_INT32_OR_64)llHdl->ma, 1);
+		int modIdMagic, modId;
+
+		modIdMagic = llHdl->idProm[0];
+		modId      = llHdl->idProm[1];
 
 		if (modIdMagic != MOD_ID_MAGIC) {
 			DBGWRT_ERR((DBH," *** M27_Init: illegal magic=0x%04x\n",modIdMagic));
@@ -265,11 +543,58 @@ int32 M27_Init(
 		}
 	}
 
+	llHdl->initIdCheck = M27_STATS_TIME(llHdl) - t;
+
+    /*------------------------------+
+    |  create locks and alarms      |
+    +------------------------------*/
+	if ((error = OSS_SpinLockCreate(osHdl, &llHdl->outLock)))
+		return( Cleanup(llHdl,error) );
+
+	if ((error = OSS_SemCreate(osHdl, OSS_SEM_BIN, 1, &llHdl->devSem)))
+		return( Cleanup(llHdl,error) );
+
+	if ((error = OSS_SemCreate(osHdl, OSS_SEM_COUNT, 0, &llHdl->genSem)))
+		return( Cleanup(llHdl,error) );
+
+	if (llHdl->lockMode == M27_LOCKMODE_CHAN) {
+		for (ch=0; ch<CH_NUMBER; ch++)
+			if ((error = OSS_SemCreate(osHdl, OSS_SEM_BIN, 1,
+									   &llHdl->chSem[ch])))
+				return( Cleanup(llHdl,error) );
+	}
+
+	if ((error = OSS_AlarmCreate(osHdl, SeqAlarm, llHdl, &llHdl->seqAlarm)))
+		return( Cleanup(llHdl,error) );
+
+	if ((error = OSS_AlarmCreate(osHdl, PwmAlarm, llHdl, &llHdl->pwmAlarm)))
+		return( Cleanup(llHdl,error) );
+
+	if ((error = OSS_AlarmCreate(osHdl, PulseAlarm, llHdl,
+								 &llHdl->pulseAlarm)))
+		return( Cleanup(llHdl,error) );
+
+	OSS_MikroDelayInit(osHdl);
+
+	llHdl->tickRate = OSS_TickRateGet(osHdl);
+
     /*------------------------------+
     |  init hardware                |
     +------------------------------*/
-	/* reset all channels */
-	MWRITE_D16( llHdl->ma, OUTPUT_REG, 0x00 );
+	t = M27_STATS_TIME(llHdl);
+
+	if (outInit == M27_OUTINIT_ADOPT) {
+		/* warm restart: keep the outputs */
+		llHdl->outShadow = MREAD_D16( llHdl->ma, OUTPUT_REG );
+	}
+	else {
+		/* reset all channels or write initial pattern */
+		MWRITE_D16( llHdl->ma, OUTPUT_REG, (u_int16)value );
+		llHdl->outShadow = (u_int16)value;
+	}
+
+	llHdl->initReset = M27_STATS_TIME(llHdl) - t;
+	llHdl->initTotal = M27_STATS_TIME(llHdl) - start;
 
 	return(ERR_SUCCESS);
 }
@@ -278,7 +603,8 @@ int32 M27_Init(
  *
  *  Description:  De-initialize hardware and cleanup memory
  *
- *                The function resets all channels.
+ *                The function stops a running sequence, the PWM and
+ *                pulses and resets all channels (unless OUTPUT_EXIT=1).
  *
  *---------------------------------------------------------------------------
  *  Input......:  llHdlP  	ptr to low level driver handle
@@ -297,8 +623,15 @@ int32 M27_Exit(
     /*------------------------------+
     |  de-init hardware             |
     +------------------------------*/
+	SeqStop(llHdl);
+	PwmStop(llHdl);
+	PulseStop(llHdl);
+
 	/* reset all channels */
-	MWRITE_D16( llHdl->ma, OUTPUT_REG, 0x00 );
+	if (llHdl->outExit == M27_OUTEXIT_RESET) {
+		MWRITE_D16( llHdl->ma, OUTPUT_REG, 0x00 );
+		llHdl->outShadow = 0x00;
+	}
 
     /*------------------------------+
     |  cleanup memory               |
@@ -315,6 +648,9 @@ int32 M27_Exit(
  *                The function reads the state of the current channel.
  *                Bit 0 of '*valueP' specify the state (0=reset, 1=set).
  *
+ *                The state is taken from the output shadow, or from the
+ *                hardware if M27_READBACK is enabled.
+ *
  *---------------------------------------------------------------------------
  *  Input......:  llHdl    ll handle
  *                ch       current channel
@@ -328,11 +664,20 @@ int32 M27_Read(
     int32 *valueP
 )
 {
+	u_int32 start = M27_STATS_TIME(llHdl);
+	OSS_SEM_HANDLE *sem;
+	int32 error;
+
     DBGWRT_1((DBH, "LL - M27_Read: ch=%d\n",ch));
 
+	if ((error = EntryLock(llHdl, ENTRY_CHANNEL, ch, &sem)))
+		return(error);
+
 	/* read channel state */
-	*valueP = (MREAD_D16(llHdl->ma, OUTPUT_REG) >> ch) & 0x01;
-	
+	*valueP = (OutputGet(llHdl) >> ch) & 0x01;
+
+	StatsEntry(llHdl, M27_ENTRY_READ, start);
+	EntryUnlock(llHdl, sem);
 	return(ERR_SUCCESS);
 }
 
@@ -342,6 +687,10 @@ int32 M27_Read(
  *
  *                The function sets the current channel, if value<>0.
  *                The function resets the current channel, if value=0.
+ *
+ *                The new output word is computed from the shadow and
+ *                written with a single access. If the channel already
+ *                has the requested state, the hardware is not accessed.
  *                
  *---------------------------------------------------------------------------
  *  Input......:  llHdl    ll handle
@@ -356,15 +705,20 @@ int32 M27_Write(
     int32 value
 )
 {
+	u_int32 start = M27_STATS_TIME(llHdl);
+	OSS_SEM_HANDLE *sem;
+	int32 error;
+
     DBGWRT_1((DBH, "LL - M27_Write: ch=%d\n",ch));
 
-	/* set channel */
-	if (value)
-		MSETMASK_D16( llHdl->ma, OUTPUT_REG, 0x01 << ch );
-	/* reset channel */
-	else
-		MCLRMASK_D16( llHdl->ma, OUTPUT_REG, 0x01 << ch );
-	
+	if ((error = EntryLock(llHdl, ENTRY_CHANNEL, ch, &sem)))
+		return(error);
+
+	/* set/reset channel */
+	OutputUpdate( llHdl, M27_SRC_WRITE, (u_int16)(0x01 << ch), (u_int16)(value ? 0xffff : 0x00), 0 );
+
+	StatsEntry(llHdl, M27_ENTRY_WRITE, start);
+	EntryUnlock(llHdl, sem);
 	return(ERR_SUCCESS);
 }
 
@@ -378,6 +732,57 @@ int32 M27_Write(
  *                -------------------  -------------------------  ----------
  *                M_LL_DEBUG_LEVEL     driver debug level         see oss.h
  *                M_LL_CH_DIR          direction of curr chan     M_CH_INOUT
+ *                M27_READBACK         read outputs from hw       0..1
+ *                M27_BLOCK_MODE       block i/o buffer layout    see m27_drv.h
+ *                M27_BLOCK_START      block i/o start channel    see m27_drv.h
+ *                M27_SET_MASK         set channels               0..0xffff
+ *                M27_CLR_MASK         reset channels             0..0xffff
+ *                M27_TOGGLE_MASK      invert channels            0..0xffff
+ *                M27_WRITE_MASKED     write channels under mask  M27_MASKED()
+ *
+ *                M27_SEQ_LOOPS        sequence loops to play     0=endless
+ *                M27_SEQ_START        start sequence             -
+ *                M27_SEQ_STOP         stop sequence              -
+ *                M27_BLK_SEQ_TABLE    load sequence table        M27_SEQ_ENTRY[]
+ *                M27_PWM_PERIOD       pwm period of curr chan    0=off, [ms]
+ *                M27_PWM_DUTY         pwm duty of curr chan      0..1000
+ *                M27_PULSE_ACTIVE     abort pulse (train)        0
+ *                M27_BLK_PULSE        fire pulse (train)         M27_PULSE
+ *                M27_STATS_RESET      clear entry statistics     -
+ *                M27_TRACE            output trace enable        0..1
+ *                M27_STAGE_MASKED     stage channels under mask  M27_MASKED()
+ *                M27_COMMIT           write staged changes       -
+ *                M27_ABORT            discard staged changes     -
+ *
+ *                The mask codes update all specified channels with one
+ *                register access. Channels not in the mask keep their state.
+ *
+ *                The sequence table is an array of M27_SEQ_ENTRY. Each entry
+ *                is written 'delta' ms after the previous one (the first
+ *                entry 'delta' ms after M27_SEQ_START). Deadlines are
+ *                absolute, so late steps do not shift the following ones.
+ *                The table can't be loaded while the sequence is running.
+ *
+ *                A channel with a PWM period >0 is driven by the PWM alarm.
+ *                All PWM channels are updated with one register access per
+ *                PWM tick. Writes to a PWM channel are overwritten at the
+ *                next tick. Setting the period to 0 resets the channel.
+ *
+ *                M27_BLK_PULSE sets the channels in 'mask' and resets them
+ *                after 'width' us, 'count' times every 'period' us.
+ *                Pulses lasting up to 1000us in total are busy-waited
+ *                within the call. Longer pulses are timed by an OSS alarm
+ *                with ms resolution (width/period rounded up) and the call
+ *                returns immediately.
+ *
+ *                M27_STAGE_MASKED doesn't access the hardware but merges
+ *                the channels into the staged changes. M27_COMMIT writes
+ *                them with one register access, M27_ABORT discards them.
+ *                All other writes (M_write, M_setblock, mask codes,
+ *                sequence, PWM, pulses) still go to the hardware
+ *                immediately, and reads return the real output state.
+ *                The staged changes belong to the device, so paths
+ *                staging at the same time share them.
  *
  *---------------------------------------------------------------------------
  *  Input......:  llHdl      ll handle
@@ -399,10 +804,25 @@ int32 M27_SetStat(
 	int32 error = ERR_SUCCESS;
     int32 value = (int32)value32_or_64;	    /* 32bit value */
     /* INT32_OR_64 valueP = value32_or_64;     stores 32/64bit pointer */
+    M_SG_BLOCK *blk = (M_SG_BLOCK*)value32_or_64;	/* block struct pointer */
+	u_int32 start = M27_STATS_TIME(llHdl);
+	OSS_SEM_HANDLE *sem;
 
     DBGWRT_1((DBH, "LL - M27_SetStat: ch=%d code=0x%04x value=0x%x\n",
 			  ch,code,value));
 
+	/* mask codes are output updates (fast path) */
+	if ((error = EntryLock(llHdl,
+						   ((code == M27_SET_MASK) ||
+							(code == M27_CLR_MASK) ||
+							(code == M27_TOGGLE_MASK) ||
+							(code == M27_WRITE_MASKED) ||
+							(code == M27_STAGE_MASKED) ||
+							(code == M27_COMMIT) ||
+							(code == M27_ABORT)) ?
+						   ENTRY_OUTPUT : ENTRY_STATUS, ch, &sem)))
+		return(error);
+
     switch(code) {
         /*--------------------------+
         |  debug level              |
@@ -436,12 +856,136 @@ int32 M27_SetStat(
 
             break;
         /*--------------------------+
+        |  read outputs from hw     |
+        +--------------------------*/
+        case M27_READBACK:
+            llHdl->readBack = value ? TRUE : FALSE;
+            break;
+        /*--------------------------+
+        |  block i/o buffer layout  |
+        +--------------------------*/
+        case M27_BLOCK_MODE:
+			switch(value) {
+				case M27_BLOCK_BYTES:
+				case M27_BLOCK_PACKED:
+					llHdl->blkMode = value;
+					break;
+				default:
+					error = ERR_LL_ILL_PARAM;
+			}
+            break;
+        /*--------------------------+
+        |  block i/o start channel  |
+        +--------------------------*/
+        case M27_BLOCK_START:
+			switch(value) {
+				case M27_BLOCK_START_CH0:
+				case M27_BLOCK_START_CURCH:
+					llHdl->blkStart = value;
+					break;
+				default:
+					error = ERR_LL_ILL_PARAM;
+			}
+            break;
+        /*--------------------------+
+        |  set/reset/invert mask    |
+        +--------------------------*/
+        case M27_SET_MASK:
+            OutputUpdate( llHdl, M27_SRC_SETSTAT, (u_int16)value, 0xffff, 0 );
+            break;
+        case M27_CLR_MASK:
+            OutputUpdate( llHdl, M27_SRC_SETSTAT, (u_int16)value, 0x0000, 0 );
+            break;
+        case M27_TOGGLE_MASK:
+            OutputUpdate( llHdl, M27_SRC_SETSTAT, 0x0000, 0x0000,
+						  (u_int16)value );
+            break;
+        /*--------------------------+
+        |  write under mask         |
+        +--------------------------*/
+        case M27_WRITE_MASKED:
+            OutputUpdate( llHdl, M27_SRC_SETSTAT,
+						  (u_int16)((u_int32)value >> 16), (u_int16)value, 0 );
+            break;
+        /*--------------------------+
+        |  sequence engine          |
+        +--------------------------*/
+        case M27_SEQ_LOOPS:
+            llHdl->seqLoops = value;
+            break;
+        case M27_SEQ_START:
+            error = SeqStart(llHdl);
+            break;
+        case M27_SEQ_STOP:
+            SeqStop(llHdl);
+            break;
+        case M27_BLK_SEQ_TABLE:
+            error = SeqLoad(llHdl, blk);
+            break;
+        /*--------------------------+
+        |  software pwm             |
+        +--------------------------*/
+        case M27_PWM_PERIOD:
+            error = PwmConfig(llHdl, ch, value, llHdl->pwmDuty[ch]);
+            break;
+        case M27_PWM_DUTY:
+            error = PwmConfig(llHdl, ch, llHdl->pwmPeriodMs[ch], value);
+            break;
+        /*--------------------------+
+        |  pulse generator          |
+        +--------------------------*/
+        case M27_BLK_PULSE:
+            error = PulseStart(llHdl, blk);
+            break;
+        case M27_PULSE_ACTIVE:
+			if (value)
+				error = ERR_LL_ILL_PARAM;
+			else
+				PulseStop(llHdl);
+            break;
+        /*--------------------------+
+        |  entry statistics         |
+        +--------------------------*/
+        case M27_STATS_RESET:
+			OSS_SpinLockAcquire(llHdl->osHdl, llHdl->outLock);
+			OSS_MemFill(llHdl->osHdl, sizeof(llHdl->statCalls),
+						(char*)llHdl->statCalls, 0);
+			OSS_MemFill(llHdl->osHdl, sizeof(llHdl->statHist),
+						(char*)llHdl->statHist, 0);
+			llHdl->statRegReads  = 0;
+			llHdl->statRegWrites = 0;
+			llHdl->statRedundant = 0;
+			llHdl->statWaits     = 0;
+			OSS_SpinLockRelease(llHdl->osHdl, llHdl->outLock);
+            break;
+        /*--------------------------+
+        |  output trace             |
+        +--------------------------*/
+        case M27_TRACE:
+            error = TraceEnable(llHdl, value);
+            break;
+        /*--------------------------+
+        |  staging                  |
+        +--------------------------*/
+        case M27_STAGE_MASKED:
+			OutputStage( llHdl, (u_int16)((u_int32)value >> 16),
+						 (u_int16)value );
+            break;
+        case M27_COMMIT:
+			StageCommit(llHdl, TRUE);
+            break;
+        case M27_ABORT:
+			StageCommit(llHdl, FALSE);
+            break;
+        /*--------------------------+
         |  (unknown)                |
         +--------------------------*/
         default:
             error = ERR_LL_UNK_CODE;
     }
 
+	StatsEntry(llHdl, M27_ENTRY_SETSTAT, start);
+	EntryUnlock(llHdl, sem);
 	return(error);
 }
 
@@ -462,6 +1006,61 @@ int32 M27_SetStat(
  *                M_LL_ID_SIZE         eeprom size [bytes]        128
  *                M_LL_BLK_ID_DATA     eeprom raw data            -
  *                M_MK_BLK_REV_ID      ident function table ptr   -
+ *                M27_READBACK         read outputs from hw       0..1
+ *                M27_BLOCK_MODE       block i/o buffer layout    see m27_drv.h
+ *                M27_BLOCK_START      block i/o start channel    see m27_drv.h
+ *                M27_SEQ_LOOPS        sequence loops to play     0=endless
+ *                M27_SEQ_STATE        sequence running           0..1
+ *                M27_SEQ_STEPS        sequence steps executed    0..
+ *                M27_SEQ_LATE         sequence steps played late 0..
+ *                M27_PWM_PERIOD       pwm period of curr chan    0=off, [ms]
+ *                M27_PWM_DUTY         pwm duty of curr chan      0..1000
+ *                M27_BLK_PWM_STATS    pwm timing statistics      M27_PWM_STATS
+ *                M27_PULSE_ACTIVE     pulse (train) active       0..1
+ *                M27_BLK_STATS        entry statistics           M27_STATS
+ *                M27_TRACE            output trace enabled       0..1
+ *                M27_STAGED           staged channels            bit mask
+ *                M27_TRACE_LOST       trace entries overwritten  0..
+ *                M27_BLK_TRACE        drain output trace         M27_TRACE_ENTRY[]
+ *                M27_LOCK_MODE        lock mode (LOCK_MODE key)  see m27_drv.h
+ *                M27_BLK_INIT_TIME    init time breakdown        M27_INIT_TIME
+ *                M27_BLK_CMDLIST      execute command list       M27_CMD[]
+ *                M27_GENERATION       output change counter      0..
+ *                M27_BLK_WAIT_CHANGE  wait for output change     M27_WAIT_CHANGE
+ *
+ *                A step is counted as late if it was played more than one
+ *                OSS tick after its deadline. The counters are cleared by
+ *                M27_SEQ_START.
+ *
+ *                The PWM statistics describe the PWM tick: the achieved
+ *                tick period is 'elapsed'/'ticks', 'maxLate' is the jitter.
+ *                They are cleared when the PWM alarm is started.
+ *
+ *                The entry statistics count the calls of each entry point
+ *                and sort their duration into log2 buckets (see M27_STATS).
+ *                Linux kernel builds measure in units of 1024 ns. Other
+ *                systems fall back to OSS ticks, where most calls land in
+ *                bucket 0; build them with M27_STATS_TIME/M27_STATS_UNIT
+ *                for a finer resolution. M27_STATS_RESET clears them.
+ *
+ *                M27_BLK_TRACE moves the oldest trace entries into the
+ *                buffer (as many as fit) and returns the nr of bytes in
+ *                blk->size. Timestamps use the unit of M27_STATS.
+ *                M27_TRACE_LOST counts the entries overwritten since the
+ *                last drain because the ring buffer was full.
+ *
+ *                M27_BLK_CMDLIST executes the M27_CMD array in the buffer
+ *                in one call and returns the status (and read results)
+ *                of each command in the same buffer (see CmdList).
+ *
+ *                M27_GENERATION counts the changes of the output register
+ *                (any source). M27_BLK_WAIT_CHANGE waits until it differs
+ *                from 'gen' (see WaitChange). It takes no entry lock, so
+ *                other calls are not blocked while it waits. Its calls
+ *                are counted separately (M27_STATS.waits), the blocking
+ *                time is not added to the GETSTAT histogram.
+ *
+ *                M_LL_BLK_ID_DATA returns the ID PROM words read at init.
  *
  *---------------------------------------------------------------------------
  *  Input......:  llHdl      ll handle
@@ -487,10 +1086,23 @@ int32 M27_GetStat(
     M_SG_BLOCK *blk = (M_SG_BLOCK*)value32_or_64P; 	    /* stores block struct pointer */
 
 	int32 error = ERR_SUCCESS;
+	u_int32 start = M27_STATS_TIME(llHdl);
+	OSS_SEM_HANDLE *sem;
 
     DBGWRT_1((DBH, "LL - M27_GetStat: ch=%d code=0x%04x\n",
 			  ch,code));
 
+	/* blocking wait must not hold the entry lock */
+	if (code == M27_BLK_WAIT_CHANGE) {
+		OSS_SpinLockAcquire(llHdl->osHdl, llHdl->outLock);
+		llHdl->statWaits++;
+		OSS_SpinLockRelease(llHdl->osHdl, llHdl->outLock);
+		return(WaitChange(llHdl, blk));
+	}
+
+	if ((error = EntryLock(llHdl, ENTRY_STATUS, ch, &sem)))
+		return(error);
+
     switch(code)
     {
         /*--------------------------+
@@ -545,18 +1157,14 @@ int32 M27_GetStat(
         |   id prom data            |
         +--------------------------*/
         case M_LL_BLK_ID_DATA:
-		{
-			u_int8 n;
-			u_int16 *dataP = (u_int16*)blk->data;
-
-			if (blk->size < MOD_ID_SIZE)		/* check buf size */
-				return(ERR_LL_USERBUF);
-
-			for (n=0; n<MOD_ID_SIZE/2; n++)		/* read MOD_ID_SIZE/2 words */
-				*dataP++ = (u_int16)m_read((U_INT32_OR_64)llHdl->ma, n);
+			if (blk->size < MOD_ID_SIZE) {		/* check buf size */
+				error = ERR_LL_USERBUF;
+				break;
+			}
 
+			OSS_MemCopy(llHdl->osHdl, MOD_ID_SIZE,
+						(char*)llHdl->idProm, (char*)blk->data);
 			break;
-		}
         /*--------------------------+
         |   ident table pointer     |
         |   (treat as non-block!)   |
@@ -565,12 +1173,168 @@ int32 M27_GetStat(
            *value64P = (INT32_OR_64)&llHdl->idFuncTbl;
            break;
         /*--------------------------+
+        |  read outputs from hw     |
+        +--------------------------*/
+        case M27_READBACK:
+            *valueP = llHdl->readBack;
+            break;
+        /*--------------------------+
+        |  block i/o buffer layout  |
+        +--------------------------*/
+        case M27_BLOCK_MODE:
+            *valueP = llHdl->blkMode;
+            break;
+        /*--------------------------+
+        |  block i/o start channel  |
+        +--------------------------*/
+        case M27_BLOCK_START:
+            *valueP = llHdl->blkStart;
+            break;
+        /*--------------------------+
+        |  sequence engine          |
+        +--------------------------*/
+        case M27_SEQ_LOOPS:
+            *valueP = llHdl->seqLoops;
+            break;
+        case M27_SEQ_STATE:
+            *valueP = llHdl->seqRun;
+            break;
+        case M27_SEQ_STEPS:
+            *valueP = llHdl->seqSteps;
+            break;
+        case M27_SEQ_LATE:
+            *valueP = llHdl->seqLate;
+            break;
+        /*--------------------------+
+        |  software pwm             |
+        +--------------------------*/
+        case M27_PWM_PERIOD:
+            *valueP = llHdl->pwmPeriodMs[ch];
+            break;
+        case M27_PWM_DUTY:
+            *valueP = llHdl->pwmDuty[ch];
+            break;
+        case M27_BLK_PWM_STATS:
+		{
+			M27_PWM_STATS *stats = (M27_PWM_STATS*)blk->data;
+
+			if (blk->size < (int32)sizeof(M27_PWM_STATS)) {
+				error = ERR_LL_USERBUF;
+				break;
+			}
+
+			OSS_SpinLockAcquire(llHdl->osHdl, llHdl->outLock);
+			stats->tickMs  = llHdl->pwmTickMs;
+			stats->ticks   = llHdl->pwmTicks;
+			stats->elapsed = llHdl->pwmElapsed;
+			stats->maxLate = llHdl->pwmMaxLate;
+			stats->late    = llHdl->pwmLate;
+			OSS_SpinLockRelease(llHdl->osHdl, llHdl->outLock);
+
+			blk->size = sizeof(M27_PWM_STATS);
+            break;
+		}
+        /*--------------------------+
+        |  pulse generator          |
+        +--------------------------*/
+        case M27_PULSE_ACTIVE:
+            *valueP = llHdl->pulseRun;
+            break;
+        /*--------------------------+
+        |  entry statistics         |
+        +--------------------------*/
+        case M27_BLK_STATS:
+		{
+			M27_STATS *stats = (M27_STATS*)blk->data;
+
+			if (blk->size < (int32)sizeof(M27_STATS)) {
+				error = ERR_LL_USERBUF;
+				break;
+			}
+
+			OSS_SpinLockAcquire(llHdl->osHdl, llHdl->outLock);
+			OSS_MemCopy(llHdl->osHdl, sizeof(stats->calls),
+						(char*)llHdl->statCalls, (char*)stats->calls);
+			OSS_MemCopy(llHdl->osHdl, sizeof(stats->hist),
+						(char*)llHdl->statHist, (char*)stats->hist);
+			stats->regReads  = llHdl->statRegReads;
+			stats->regWrites = llHdl->statRegWrites;
+			stats->redundant = llHdl->statRedundant;
+			stats->waits     = llHdl->statWaits;
+			OSS_SpinLockRelease(llHdl->osHdl, llHdl->outLock);
+
+			stats->unitNs = M27_STATS_UNIT(llHdl);
+			blk->size = sizeof(M27_STATS);
+            break;
+		}
+        /*--------------------------+
+        |  output trace             |
+        +--------------------------*/
+        case M27_TRACE:
+            *valueP = llHdl->trcOn;
+            break;
+        case M27_TRACE_LOST:
+            *valueP = llHdl->trcLost;
+            break;
+        case M27_BLK_TRACE:
+			if (llHdl->trcBuf == NULL)
+				blk->size = 0;
+			else
+				TraceDrain(llHdl, blk);
+            break;
+        /*--------------------------+
+        |  staging                  |
+        +--------------------------*/
+        case M27_STAGED:
+            *valueP = llHdl->stgMask;
+            break;
+        /*--------------------------+
+        |  output generation        |
+        +--------------------------*/
+        case M27_GENERATION:
+            *valueP = llHdl->outGen;
+            break;
+        /*--------------------------+
+        |  locking                  |
+        +--------------------------*/
+        case M27_LOCK_MODE:
+            *valueP = llHdl->lockMode;
+            break;
+        /*--------------------------+
+        |  init time                |
+        +--------------------------*/
+        case M27_BLK_INIT_TIME:
+		{
+			M27_INIT_TIME *it = (M27_INIT_TIME*)blk->data;
+
+			if (blk->size < (int32)sizeof(M27_INIT_TIME)) {
+				error = ERR_LL_USERBUF;
+				break;
+			}
+
+			it->unitNs  = M27_STATS_UNIT(llHdl);
+			it->desc    = llHdl->initDesc;
+			it->idCheck = llHdl->initIdCheck;
+			it->reset   = llHdl->initReset;
+			it->total   = llHdl->initTotal;
+			blk->size = sizeof(M27_INIT_TIME);
+            break;
+		}
+        /*--------------------------+
+        |  command list             |
+        +--------------------------*/
+        case M27_BLK_CMDLIST:
+            error = CmdList(llHdl, blk);
+            break;
+        /*--------------------------+
         |  (unknown)                |
         +--------------------------*/
         default:
             error = ERR_LL_UNK_CODE;
     }
 
+	StatsEntry(llHdl, M27_ENTRY_GETSTAT, start);
+	EntryUnlock(llHdl, sem);
 	return(error);
 }
 
@@ -581,10 +1345,15 @@ int32 M27_GetStat(
  *                Read channels 0..('size'-1) into 'buf'.
  *                Channels will be read in rising order (0..size-1).
  *
+ *                If M27_BLOCK_START is set to M27_BLOCK_START_CURCH, the
+ *                transfer starts at the current channel 'ch' instead of
+ *                channel 0 (channels ch..ch+size-1).
+ *
  *                Buffer modes:
- *                   The function always reads from the hardware.
+ *                   The function reads from the output shadow, or from
+ *                   the hardware if M27_READBACK is enabled.
  *
- *                Buffer structure:
+ *                Buffer structure (M27_BLOCK_BYTES):
  *                   The data buffer uses one byte per channel:
  *
  *                   +---------+
@@ -597,7 +1366,12 @@ int32 M27_GetStat(
  *                   |  byte n |  channel 'size'-1  
  *                   +---------+
  *
- *                Byte layout:
+ *                Buffer structure (M27_BLOCK_PACKED):
+ *                   The data buffer is one u_int16 in native byte order,
+ *                   one bit per channel (bit n = channel n), 'size' must
+ *                   be 2. The buffer needs no alignment.
+ *
+ *                Byte layout (M27_BLOCK_BYTES):
  *                   Bit 0 shows the state of the channel: 
  *
  *                   Bit    7 6 5 4 3 2 1 0
@@ -610,8 +1384,8 @@ int32 M27_GetStat(
  *  Input......:  llHdl        ll handle
  *                ch           current channel
  *                buf          data buffer
- *                size         data buffer size  (0..16)
- *  Output.....:  nbrRdBytesP  number of read bytes (0..16)
+ *                size         data buffer size  (0..16 or 2)
+ *  Output.....:  nbrRdBytesP  number of read bytes (0..16 or 2)
  *                return       success (0) or error code
  *  Globals....:  ---
  ****************************************************************************/
@@ -624,28 +1398,44 @@ int32 M27_BlockRead(
 )
 {
 	u_int16 value, i;
+	int32 first, chNbr, error;
+	u_int32 start = M27_STATS_TIME(llHdl);
+	OSS_SEM_HANDLE *sem;
 
     DBGWRT_1((DBH, "LL - M27_BlockRead: ch=%d, size=%d\n",ch,size));
 
 	/* set nr of read bytes */
 	*nbrRdBytesP = 0;
 
-	/* check for size 0..16 */
-	if( (size < 0) || (size > CH_NUMBER) )
+	if ((error = EntryLock(llHdl, ENTRY_OUTPUT, ch, &sem)))
+		return(error);
+
+	/* check channel range */
+	if( (chNbr = BlockChannels(llHdl, ch, size, &first)) < 0 ) {
+		StatsEntry(llHdl, M27_ENTRY_BLKREAD, start);
+		EntryUnlock(llHdl, sem);
 		return ERR_LL_ILL_PARAM;
+	}
 
 	/* read all channels */
-	value = MREAD_D16( llHdl->ma, OUTPUT_REG );
+	value = (u_int16)(OutputGet( llHdl ) >> first);
 
+	/* packed: copy word as is (buffer may be unaligned) */
+	if (llHdl->blkMode == M27_BLOCK_PACKED)
+		OSS_MemCopy(llHdl->osHdl, sizeof(value), (char*)&value, (char*)buf);
 	/* expand 'size' bits -> 'size' bytes */
-	for (i=0; i<size; i++) {
-		*((int8*)buf+i) = value & 0x1;
-		value = value >> 1;
+	else {
+		for (i=0; i<size; i++) {
+			*((int8*)buf+i) = value & 0x1;
+			value = value >> 1;
+		}
 	}
 
 	/* update nr of read bytes */
 	*nbrRdBytesP = size;
 
+	StatsEntry(llHdl, M27_ENTRY_BLKREAD, start);
+	EntryUnlock(llHdl, sem);
 	return(ERR_SUCCESS);
 }
 
@@ -655,11 +1445,18 @@ int32 M27_BlockRead(
  *
  *                Write channels 0..('size'-1) into 'buf'.
  *                Channels will be written in rising order (0..size-1).
+ *                The other channels keep their state.
+ *
+ *                If M27_BLOCK_START is set to M27_BLOCK_START_CURCH, the
+ *                transfer starts at the current channel 'ch' instead of
+ *                channel 0 (channels ch..ch+size-1).
  *
  *                Buffer modes:
- *                   The function always writes from the hardware.
+ *                   The function always writes to the hardware.
+ *                   The output word is computed from the shadow and
+ *                   written with a single access (skipped if unchanged).
  *
- *                Buffer structure:
+ *                Buffer structure (M27_BLOCK_BYTES):
  *                   The data buffer uses one byte per channel:
  *
  *                   +---------+
@@ -672,7 +1469,12 @@ int32 M27_BlockRead(
  *                   |  byte n |  channel 'size'-1  
  *                   +---------+
  *
- *                Byte layout:
+ *                Buffer structure (M27_BLOCK_PACKED):
+ *                   The data buffer is one u_int16 in native byte order,
+ *                   one bit per channel (bit n = channel n), 'size' must
+ *                   be 2. The buffer needs no alignment.
+ *
+ *                Byte layout (M27_BLOCK_BYTES):
  *                   If any bit is set, than the channel will be set.
  *                   If all bits are 0, than the channel will be reseted.
  *
@@ -680,8 +1482,8 @@ int32 M27_BlockRead(
  *  Input......:  llHdl        ll handle
  *                ch           current channel
  *                buf          data buffer
- *                size         data buffer size (0..16)
- *  Output.....:  nbrWrBytesP  number of written bytes (0..16)
+ *                size         data buffer size (0..16 or 2)
+ *  Output.....:  nbrWrBytesP  number of written bytes (0..16 or 2)
  *                return       success (0) or error code
  *  Globals....:  ---
  ****************************************************************************/
@@ -693,32 +1495,45 @@ int32 M27_BlockWrite(
      int32     *nbrWrBytesP
 )
 {
-	u_int16 value=0, oldValue, i;
+	u_int16 value=0, i;
+	int32 first, chNbr, error;
+	u_int32 start = M27_STATS_TIME(llHdl);
+	OSS_SEM_HANDLE *sem;
 
     DBGWRT_1((DBH, "LL - M27_BlockWrite: ch=%d, size=%d\n",ch,size));
 
 	/* set nr of written bytes */
 	*nbrWrBytesP = 0;
 
-	/* check for size 0..16 */
-	if( (size < 0) || (size > CH_NUMBER) )
-		return ERR_LL_ILL_PARAM;
+	if ((error = EntryLock(llHdl, ENTRY_OUTPUT, ch, &sem)))
+		return(error);
 
-	/* read all channels */
-	oldValue = MREAD_D16( llHdl->ma, OUTPUT_REG );
+	/* check channel range */
+	if( (chNbr = BlockChannels(llHdl, ch, size, &first)) < 0 ) {
+		StatsEntry(llHdl, M27_ENTRY_BLKWRITE, start);
+		EntryUnlock(llHdl, sem);
+		return ERR_LL_ILL_PARAM;
+	}
 
+	/* packed: take word as is (buffer may be unaligned) */
+	if (llHdl->blkMode == M27_BLOCK_PACKED)
+		OSS_MemCopy(llHdl->osHdl, sizeof(value), (char*)buf, (char*)&value);
 	/* compress 'size' bytes -> 'size' bits */
-	for (i=0; i<size; i++)
-		value |= ((*((int8*)buf+i) ? 1 : 0) << i);
+	else {
+		for (i=0; i<size; i++)
+			value |= ((*((int8*)buf+i) ? 1 : 0) << i);
+	}
 
-	value |= (oldValue & (0xffff << size));
-	
-	/* write all channels */
-	MWRITE_D16( llHdl->ma, OUTPUT_REG, value );
+	/* write channels first..first+chNbr-1, keep the others */
+	OutputUpdate( llHdl, M27_SRC_BLKWRITE,
+				  (u_int16)((0xffffUL >> (CH_NUMBER - chNbr)) << first),
+				  (u_int16)(value << first), 0 );
 
 	/* update nr of written bytes */
 	*nbrWrBytesP = size;
 
+	StatsEntry(llHdl, M27_ENTRY_BLKWRITE, start);
+	EntryUnlock(llHdl, sem);
 	return(ERR_SUCCESS);
 }
 
@@ -777,6 +1592,9 @@ int32 M27_Irq(
  *
  *                The LL_INFO_LOCKMODE code returns, which process locking
  *                mode is required from the driver (LL_LOCK_xxx).
+ *                The driver returns LL_LOCK_NONE and serializes its callers
+ *                itself, because the lock mode is selected per device by
+ *                descriptor (LOCK_MODE) and this info has no handle.
  *
  *---------------------------------------------------------------------------
  *  Input......:  infoType	   info code
@@ -857,7 +1675,7 @@ int32 M27_Info(
 		{
 			u_int32 *lockModeP = va_arg(argptr, u_int32*);
 
-			*lockModeP = LL_LOCK_CALL;
+			*lockModeP = LL_LOCK_NONE;	/* see EntryLock() */
 			break;
 	    }
 		/*-------------------------------+
@@ -885,35 +1703,1190 @@ static char* Ident( void )
     return( (char*) IdentString );
 }
 
-/********************************* Cleanup **********************************
+/******************************* OutputUpdate *******************************
+ *
+ *  Description: Update output channels
+ *
+ *               The new output word is computed from the shadow:
+ *                 new = ((shadow & ~mask) | (value & mask)) ^ toggle
+ *               and written to OUTPUT_REG with a single access.
+ *               The write is skipped if the word does not change.
  *
- *  Description: Close all handles, free memory and return error code
- *		         NOTE: The ll handle is invalid after calling this function
- *			   
  *---------------------------------------------------------------------------
  *  Input......: llHdl		ll handle
- *               retCode    return value
- *  Output.....: return	    retCode
+ *               src        source of the update (M27_SRC_xxx)
+ *               mask       channels to update
+ *               value      new channel states
+ *               toggle     channels to invert
+ *  Output.....: -
  *  Globals....: -
  ****************************************************************************/
-static int32 Cleanup(
+static void OutputUpdate(
    LL_HANDLE    *llHdl,
-   int32        retCode
+   u_int16      src,
+   u_int16      mask,
+   u_int16      value,
+   u_int16      toggle
 )
 {
-    /*------------------------------+
-    |  close handles                |
-    +------------------------------*/
-	/* clean up desc */
-	if (llHdl->descHdl)
-		DESC_Exit(&llHdl->descHdl);
+	OSS_SpinLockAcquire(llHdl->osHdl, llHdl->outLock);
 
-	/* cleanup debug */
-	DBGEXIT((&DBH));
+	OutputWrite(llHdl, src,
+				(u_int16)(((llHdl->outShadow & ~mask) | (value & mask)) ^ toggle));
+
+	OSS_SpinLockRelease(llHdl->osHdl, llHdl->outLock);
+}
+
+/******************************* OutputStage ********************************
+ *
+ *  Description: Merge channels into the staged changes (M27_STAGE_MASKED)
+ *
+ *               The hardware is not accessed, see StageCommit.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: llHdl   ll handle
+ *               mask    channels to stage
+ *               value   new channel states (bits in mask)
+ *  Output.....: -
+ *  Globals....: -
+ ****************************************************************************/
+static void OutputStage(
+   LL_HANDLE    *llHdl,
+   u_int16      mask,
+   u_int16      value
+)
+{
+	OSS_SpinLockAcquire(llHdl->osHdl, llHdl->outLock);
+	llHdl->stgValue = (u_int16)((llHdl->stgValue & ~mask) | (value & mask));
+	llHdl->stgMask |= mask;
+	OSS_SpinLockRelease(llHdl->osHdl, llHdl->outLock);
+}
+
+/******************************* StageCommit ********************************
+ *
+ *  Description: Write or discard the staged changes
+ *
+ *               Only the staged channels are written, so changes made by
+ *               the sequence, PWM or pulses in the meantime are kept.
+ *               Nothing is written if no channel is staged.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: llHdl   ll handle
+ *               commit  TRUE: write, FALSE: discard
+ *  Output.....: -
+ *  Globals....: -
+ ****************************************************************************/
+static void StageCommit(
+   LL_HANDLE    *llHdl,
+   u_int32      commit
+)
+{
+	OSS_SpinLockAcquire(llHdl->osHdl, llHdl->outLock);
+
+	if (commit && llHdl->stgMask)
+		OutputWrite(llHdl, M27_SRC_COMMIT,
+					(u_int16)((llHdl->outShadow & ~llHdl->stgMask) |
+							  (llHdl->stgValue & llHdl->stgMask)));
+
+	llHdl->stgMask  = 0x0000;
+	llHdl->stgValue = 0x0000;
+
+	OSS_SpinLockRelease(llHdl->osHdl, llHdl->outLock);
+}
+
+/******************************* OutputWrite ********************************
+ *
+ *  Description: Write output word, if it differs from the shadow
+ *
+ *               The caller must hold the output lock. If the trace is
+ *               enabled, the change is recorded.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: llHdl		ll handle
+ *               src        source of the update (M27_SRC_xxx)
+ *               value      new output word
+ *  Output.....: -
+ *  Globals....: -
+ ****************************************************************************/
+static void OutputWrite(
+   LL_HANDLE    *llHdl,
+   u_int16      src,
+   u_int16      value
+)
+{
+	if (value == llHdl->outShadow) {
+		llHdl->statRedundant++;
+		return;
+	}
+
+	if (llHdl->trcOn) {
+		M27_TRACE_ENTRY *trc = &llHdl->trcBuf[llHdl->trcHead];
+
+		trc->time     = M27_STATS_TIME(llHdl);
+		trc->oldWord  = llHdl->outShadow;
+		trc->newWord  = value;
+		trc->src      = src;
+		trc->reserved = 0;
+
+		llHdl->trcHead = (llHdl->trcHead + 1) % M27_TRACE_SIZE;
+		if (llHdl->trcCount < M27_TRACE_SIZE)
+			llHdl->trcCount++;
+		else
+			llHdl->trcLost++;
+	}
+
+	MWRITE_D16( llHdl->ma, OUTPUT_REG, value );
+	llHdl->outShadow = value;
+	llHdl->statRegWrites++;
+
+	OutputChanged(llHdl);
+}
+
+/****************************** OutputChanged *******************************
+ *
+ *  Description: Advance output generation and wake up waiters
+ *
+ *               The caller must hold the output lock. Every waiter
+ *               registered in genWaiters gets one semaphore count.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: llHdl		ll handle
+ *  Output.....: -
+ *  Globals....: -
+ ****************************************************************************/
+static void OutputChanged(
+   LL_HANDLE    *llHdl
+)
+{
+	llHdl->outGen++;
+
+	while (llHdl->genWaiters) {
+		llHdl->genWaiters--;
+		OSS_SemSignal(llHdl->osHdl, llHdl->genSem);
+	}
+}
+
+/******************************** WaitChange ********************************
+ *
+ *  Description: Wait until the output generation differs (M27_BLK_WAIT_CHANGE)
+ *
+ *               Returns immediately if the generation already differs
+ *               from wc->gen. Otherwise the caller registers as waiter
+ *               and sleeps on genSem until a change, the timeout or a
+ *               signal. A semaphore count left by a waiter that timed
+ *               out only causes one extra check of the generation.
+ *
+ *               The current generation and output word are returned
+ *               also on timeout.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: llHdl		ll handle
+ *               blk        block with M27_WAIT_CHANGE
+ *  Output.....: return     success (0), ERR_OSS_TIMEOUT or error code
+ *  Globals....: -
+ ****************************************************************************/
+static int32 WaitChange(
+   LL_HANDLE    *llHdl,
+   M_SG_BLOCK   *blk
+)
+{
+	M27_WAIT_CHANGE *wc = (M27_WAIT_CHANGE*)blk->data;
+	u_int32 start, elapsed;
+	int32 msec, error = ERR_SUCCESS;
+
+	if (blk->size < (int32)sizeof(M27_WAIT_CHANGE))
+		return(ERR_LL_USERBUF);
+
+	start = OSS_TickGet(llHdl->osHdl);
+
+	OSS_SpinLockAcquire(llHdl->osHdl, llHdl->outLock);
+
+	while (llHdl->outGen == wc->gen) {
+		/* remaining time */
+		msec = wc->timeout;
+		if (msec > 0) {
+			elapsed = TicksToMs(llHdl,
+								OSS_TickGet(llHdl->osHdl) - start);
+			msec = (elapsed < (u_int32)msec) ? msec - (int32)elapsed : 0;
+		}
+		if (msec == 0) {
+			error = ERR_OSS_TIMEOUT;
+			break;
+		}
+
+		llHdl->genWaiters++;
+		OSS_SpinLockRelease(llHdl->osHdl, llHdl->outLock);
+
+		error = OSS_SemWait(llHdl->osHdl, llHdl->genSem,
+							msec < 0 ? OSS_SEM_WAITFOREVER : msec);
+
+		OSS_SpinLockAcquire(llHdl->osHdl, llHdl->outLock);
+
+		if (error) {
+			/* not signalled: unregister */
+			if (llHdl->genWaiters)
+				llHdl->genWaiters--;
+			if (error == ERR_OSS_TIMEOUT && llHdl->outGen != wc->gen)
+				error = ERR_SUCCESS;
+			break;
+		}
+	}
+
+	wc->gen  = llHdl->outGen;
+	wc->word = llHdl->outShadow;
+
+	OSS_SpinLockRelease(llHdl->osHdl, llHdl->outLock);
+
+	wc->reserved = 0;
+	blk->size = sizeof(M27_WAIT_CHANGE);
+	return(error);
+}
+
+/******************************** OutputGet *********************************
+ *
+ *  Description: Get state of all output channels
+ *
+ *               If M27_READBACK is enabled, OUTPUT_REG is read and the
+ *               shadow is resynchronized (a difference counts as output
+ *               change). Otherwise the shadow is returned.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: llHdl		ll handle
+ *  Output.....: return     output word
+ *  Globals....: -
+ ****************************************************************************/
+static u_int16 OutputGet(
+   LL_HANDLE    *llHdl
+)
+{
+	u_int16 value;
+
+	if (!llHdl->readBack)
+		return( llHdl->outShadow );
+
+	OSS_SpinLockAcquire(llHdl->osHdl, llHdl->outLock);
+	value = MREAD_D16( llHdl->ma, OUTPUT_REG );
+	llHdl->statRegReads++;
+	if (value != llHdl->outShadow) {
+		llHdl->outShadow = value;
+		OutputChanged(llHdl);
+	}
+	OSS_SpinLockRelease(llHdl->osHdl, llHdl->outLock);
+
+	return( value );
+}
+
+/******************************* TraceEnable ********************************
+ *
+ *  Description: Enable/disable output trace
+ *
+ *               The ring buffer is allocated when the trace is enabled
+ *               the first time. Enabling clears the buffer, disabling
+ *               keeps it for draining.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: llHdl		ll handle
+ *               on         enable
+ *  Output.....: return     success (0) or error code
+ *  Globals....: -
+ ****************************************************************************/
+static int32 TraceEnable(
+   LL_HANDLE    *llHdl,
+   u_int32      on
+)
+{
+	u_int32 gotsize;
+
+	if (on && (llHdl->trcBuf == NULL)) {
+		if ((llHdl->trcBuf = (M27_TRACE_ENTRY*)
+			 OSS_MemGet(llHdl->osHdl, M27_TRACE_SIZE * sizeof(M27_TRACE_ENTRY),
+						&gotsize)) == NULL)
+			return(ERR_OSS_MEM_ALLOC);
+		llHdl->trcAlloc = gotsize;
+	}
+
+	OSS_SpinLockAcquire(llHdl->osHdl, llHdl->outLock);
+	if (on) {
+		llHdl->trcHead  = 0;
+		llHdl->trcCount = 0;
+		llHdl->trcLost  = 0;
+	}
+	llHdl->trcOn = on ? TRUE : FALSE;
+	OSS_SpinLockRelease(llHdl->osHdl, llHdl->outLock);
+
+	return(ERR_SUCCESS);
+}
+
+/******************************** TraceDrain ********************************
+ *
+ *  Description: Move trace entries (oldest first) into user buffer
+ *
+ *               Copies as many entries as fit into the buffer and removes
+ *               them from the ring buffer. The lost counter is cleared.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: llHdl		ll handle
+ *               blk        buffer (M27_TRACE_ENTRY[])
+ *  Output.....: blk->size  nr of bytes copied
+ *  Globals....: -
+ ****************************************************************************/
+static void TraceDrain(
+   LL_HANDLE    *llHdl,
+   M_SG_BLOCK   *blk
+)
+{
+	M27_TRACE_ENTRY *dst = (M27_TRACE_ENTRY*)blk->data;
+	u_int32 n, nbr, tail;
+
+	nbr = blk->size / sizeof(M27_TRACE_ENTRY);
+
+	OSS_SpinLockAcquire(llHdl->osHdl, llHdl->outLock);
+
+	if (nbr > llHdl->trcCount)
+		nbr = llHdl->trcCount;
+
+	tail = (llHdl->trcHead + M27_TRACE_SIZE - llHdl->trcCount) % M27_TRACE_SIZE;
+
+	for (n=0; n<nbr; n++)
+		dst[n] = llHdl->trcBuf[(tail + n) % M27_TRACE_SIZE];
+
+	llHdl->trcCount -= nbr;
+	llHdl->trcLost   = 0;
+
+	OSS_SpinLockRelease(llHdl->osHdl, llHdl->outLock);
+
+	blk->size = nbr * sizeof(M27_TRACE_ENTRY);
+}
+
+/******************************** EntryLock *********************************
+ *
+ *  Description: Serialize entry point call according to LOCK_MODE
+ *
+ *               LOCK_MODE  status     output     channel
+ *               ---------  ---------  ---------  ---------
+ *               0          device     device     device
+ *               1          device     -          -
+ *               2          device     device     channel
+ *
+ *               (device/channel: device/channel semaphore taken,
+ *               -: output spin lock only)
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: llHdl		ll handle
+ *               entry      entry point class (ENTRY_xxx)
+ *               ch         current channel
+ *  Output.....: semP       semaphore taken or NULL (pass to EntryUnlock)
+ *               return     success (0) or error code
+ *  Globals....: -
+ ****************************************************************************/
+static int32 EntryLock(
+   LL_HANDLE    *llHdl,
+   u_int32      entry,
+   int32        ch,
+   OSS_SEM_HANDLE **semP
+)
+{
+	OSS_SEM_HANDLE *sem = llHdl->devSem;
+	int32 error;
+
+	*semP = NULL;
+
+	switch (llHdl->lockMode) {
+		case M27_LOCKMODE_FAST:
+			if (entry != ENTRY_STATUS)
+				return(ERR_SUCCESS);
+			break;
+		case M27_LOCKMODE_CHAN:
+			if (entry == ENTRY_CHANNEL)
+				sem = llHdl->chSem[ch];
+			break;
+	}
+
+	if ((error = OSS_SemWait(llHdl->osHdl, sem, OSS_SEM_WAITFOREVER)))
+		return(error);
+
+	*semP = sem;
+	return(ERR_SUCCESS);
+}
+
+/******************************** EntryUnlock *******************************
+ *
+ *  Description: Release lock taken by EntryLock
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: llHdl		ll handle
+ *               sem        semaphore taken or NULL
+ *  Output.....: -
+ *  Globals....: -
+ ****************************************************************************/
+static void EntryUnlock(
+   LL_HANDLE    *llHdl,
+   OSS_SEM_HANDLE *sem
+)
+{
+	if (sem)
+		OSS_SemSignal(llHdl->osHdl, sem);
+}
+
+/******************************** StatsEntry ********************************
+ *
+ *  Description: Count entry point call and its duration
+ *
+ *               Bucket 0 counts calls shorter than one time unit, bucket
+ *               n calls of 2^(n-1)..2^n-1 units, the last bucket all
+ *               longer calls. The counters are updated without lock,
+ *               so they are exact with LOCK_MODE 0 and approximate for
+ *               concurrent calls with LOCK_MODE 1/2.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: llHdl		ll handle
+ *               entry      entry point (M27_ENTRY_xxx)
+ *               start      M27_STATS_TIME at entry
+ *  Output.....: -
+ *  Globals....: -
+ ****************************************************************************/
+static void StatsEntry(
+   LL_HANDLE    *llHdl,
+   u_int32      entry,
+   u_int32      start
+)
+{
+	u_int32 time = M27_STATS_TIME(llHdl) - start;
+	u_int32 bucket = 0;
+
+	while (time && (bucket < STATS_BUCKETS - 1)) {
+		time >>= 1;
+		bucket++;
+	}
+
+	llHdl->statCalls[entry]++;
+	llHdl->statHist[entry][bucket]++;
+}
+
+/****************************** BlockChannels *******************************
+ *
+ *  Description: Get and check channel range of a block transfer
+ *
+ *               The range starts at channel 0, or at the current channel
+ *               if M27_BLOCK_START_CURCH is selected. Its length is 'size'
+ *               channels (M27_BLOCK_BYTES) or 16 channels
+ *               (M27_BLOCK_PACKED, 'size' must be 2).
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: llHdl		ll handle
+ *               ch         current channel
+ *               size       data buffer size
+ *  Output.....: firstP     first channel
+ *               return     nr of channels or -1 if range is illegal
+ *  Globals....: -
+ ****************************************************************************/
+static int32 BlockChannels(
+   LL_HANDLE    *llHdl,
+   int32        ch,
+   int32        size,
+   int32        *firstP
+)
+{
+	int32 chNbr = size;
+
+	*firstP = (llHdl->blkStart == M27_BLOCK_START_CURCH) ? ch : 0;
+
+	if (llHdl->blkMode == M27_BLOCK_PACKED) {
+		if (size != sizeof(u_int16))
+			return(-1);
+		chNbr = CH_NUMBER;
+	}
+
+	if ( (size < 0) || (*firstP < 0) || (*firstP + chNbr > CH_NUMBER) )
+		return(-1);
+
+	return(chNbr);
+}
+
+/******************************** TicksToMs *********************************
+ *
+ *  Description: Convert OSS ticks to milliseconds (without overflow)
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: llHdl		ll handle
+ *               ticks      nr of ticks
+ *  Output.....: return     milliseconds
+ *  Globals....: -
+ ****************************************************************************/
+static u_int32 TicksToMs(
+   LL_HANDLE    *llHdl,
+   u_int32      ticks
+)
+{
+	return( (ticks / llHdl->tickRate) * 1000 +
+			((ticks % llHdl->tickRate) * 1000) / llHdl->tickRate );
+}
+
+/********************************* SeqLoad **********************************
+ *
+ *  Description: Load sequence table
+ *
+ *               The table is copied into driver memory. It must contain
+ *               1..M27_SEQ_MAX entries and the sum of all deltas must not
+ *               be zero (the table could never be left otherwise).
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: llHdl		ll handle
+ *               blk        block with M27_SEQ_ENTRY array
+ *  Output.....: return     success (0) or error code
+ *  Globals....: -
+ ****************************************************************************/
+static int32 SeqLoad(
+   LL_HANDLE    *llHdl,
+   M_SG_BLOCK   *blk
+)
+{
+	M27_SEQ_ENTRY *tbl, *oldTbl, *src = (M27_SEQ_ENTRY*)blk->data;
+	u_int32 n, len, total=0, gotsize, oldAlloc;
+
+	len = blk->size / sizeof(M27_SEQ_ENTRY);
+
+	if ( (blk->size % sizeof(M27_SEQ_ENTRY)) ||
+		 (len < 1) || (len > M27_SEQ_MAX) )
+		return(ERR_LL_ILL_PARAM);
+
+	for (n=0; n<len; n++)
+		total |= src[n].delta;
+
+	if (total == 0)
+		return(ERR_LL_ILL_PARAM);
+
+	if (llHdl->seqRun)
+		return(ERR_LL_DEV_BUSY);
+
+	if ((tbl = (M27_SEQ_ENTRY*)OSS_MemGet(llHdl->osHdl, blk->size,
+										  &gotsize)) == NULL)
+		return(ERR_OSS_MEM_ALLOC);
+
+	OSS_MemCopy(llHdl->osHdl, blk->size, (char*)src, (char*)tbl);
+
+	/* exchange tables */
+	OSS_SpinLockAcquire(llHdl->osHdl, llHdl->outLock);
+	oldTbl   = llHdl->seqTbl;
+	oldAlloc = llHdl->seqTblAlloc;
+	llHdl->seqTbl      = tbl;
+	llHdl->seqTblAlloc = gotsize;
+	llHdl->seqLen      = len;
+	OSS_SpinLockRelease(llHdl->osHdl, llHdl->outLock);
+
+	if (oldTbl)
+		OSS_MemFree(llHdl->osHdl, (int8*)oldTbl, oldAlloc);
+
+	return(ERR_SUCCESS);
+}
+
+/********************************* SeqStart *********************************
+ *
+ *  Description: Start sequence playback from the first table entry
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: llHdl		ll handle
+ *  Output.....: return     success (0) or error code
+ *  Globals....: -
+ ****************************************************************************/
+static int32 SeqStart(
+   LL_HANDLE    *llHdl
+)
+{
+	u_int32 realMsec;
+
+	if (llHdl->seqTbl == NULL)
+		return(ERR_LL_ILL_PARAM);
+
+	SeqStop(llHdl);
+
+	OSS_SpinLockAcquire(llHdl->osHdl, llHdl->outLock);
+	llHdl->seqIdx       = 0;
+	llHdl->seqLoop      = 0;
+	llHdl->seqSteps     = 0;
+	llHdl->seqLate      = 0;
+	llHdl->seqStartTick = OSS_TickGet(llHdl->osHdl);
+	llHdl->seqDeadline  = llHdl->seqTbl[0].delta;
+	llHdl->seqRun       = TRUE;
+	OSS_SpinLockRelease(llHdl->osHdl, llHdl->outLock);
+
+	/* first entry due now: play it directly */
+	if (llHdl->seqDeadline == 0) {
+		SeqAlarm(llHdl);
+		return(ERR_SUCCESS);
+	}
+
+	return( OSS_AlarmSet(llHdl->osHdl, llHdl->seqAlarm, llHdl->seqDeadline,
+						 FALSE, &realMsec) );
+}
+
+/********************************* SeqStop **********************************
+ *
+ *  Description: Stop sequence playback
+ *
+ *               The outputs keep their current state.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: llHdl		ll handle
+ *  Output.....: -
+ *  Globals....: -
+ ****************************************************************************/
+static void SeqStop(
+   LL_HANDLE    *llHdl
+)
+{
+	OSS_SpinLockAcquire(llHdl->osHdl, llHdl->outLock);
+	llHdl->seqRun = FALSE;
+	OSS_SpinLockRelease(llHdl->osHdl, llHdl->outLock);
+
+	OSS_AlarmClear(llHdl->osHdl, llHdl->seqAlarm);
+}
+
+/********************************* SeqAlarm *********************************
+ *
+ *  Description: Sequence alarm routine
+ *
+ *               Plays all steps whose deadline has passed and re-arms
+ *               the alarm for the next deadline.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: arg		ll handle
+ *  Output.....: -
+ *  Globals....: -
+ ****************************************************************************/
+static void SeqAlarm(
+   void *arg
+)
+{
+	LL_HANDLE *llHdl = (LL_HANDLE*)arg;
+	u_int32 now, wait, realMsec, tickMs;
+
+	tickMs = (1000 + llHdl->tickRate - 1) / llHdl->tickRate;
+
+	OSS_SpinLockAcquire(llHdl->osHdl, llHdl->outLock);
+
+	if (!llHdl->seqRun) {
+		OSS_SpinLockRelease(llHdl->osHdl, llHdl->outLock);
+		return;
+	}
+
+	now = TicksToMs(llHdl, OSS_TickGet(llHdl->osHdl) - llHdl->seqStartTick);
+
+	/* play all due steps */
+	while ((int32)(llHdl->seqDeadline - now) <= 0) {
+		if ((now - llHdl->seqDeadline) > tickMs)
+			llHdl->seqLate++;
+
+		OutputWrite(llHdl, M27_SRC_SEQ, llHdl->seqTbl[llHdl->seqIdx].word);
+		llHdl->seqSteps++;
+
+		/* end of table? */
+		if (++llHdl->seqIdx >= llHdl->seqLen) {
+			llHdl->seqIdx = 0;
+
+			if (llHdl->seqLoops && (++llHdl->seqLoop >= llHdl->seqLoops)) {
+				llHdl->seqRun = FALSE;
+				OSS_SpinLockRelease(llHdl->osHdl, llHdl->outLock);
+				return;
+			}
+		}
+		llHdl->seqDeadline += llHdl->seqTbl[llHdl->seqIdx].delta;
+	}
+
+	wait = llHdl->seqDeadline - now;
+
+	OSS_SpinLockRelease(llHdl->osHdl, llHdl->outLock);
+
+	OSS_AlarmSet(llHdl->osHdl, llHdl->seqAlarm, wait, FALSE, &realMsec);
+}
+
+/******************************** PwmConfig *********************************
+ *
+ *  Description: Configure software PWM of one channel
+ *
+ *               Period and on-time are converted to PWM ticks. The PWM
+ *               alarm is started with the first and stopped with the last
+ *               PWM channel. If the alarm can't be started, the settings
+ *               of the channel are left unchanged.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: llHdl		ll handle
+ *               ch         channel
+ *               periodMs   period [ms] (0=off)
+ *               duty       duty cycle [1/1000]
+ *  Output.....: return     success (0) or error code
+ *  Globals....: -
+ ****************************************************************************/
+static int32 PwmConfig(
+   LL_HANDLE    *llHdl,
+   int32        ch,
+   u_int32      periodMs,
+   u_int32      duty
+)
+{
+	u_int16 chMask = (u_int16)(0x01 << ch);
+	u_int32 realMsec, n, period;
+	int32 error = ERR_SUCCESS;
+
+	if (duty > 1000)
+		return(ERR_LL_ILL_PARAM);
+
+	/* channel off: stop alarm with last channel */
+	if (periodMs == 0) {
+		llHdl->pwmPeriodMs[ch] = periodMs;
+		llHdl->pwmDuty[ch]     = duty;
+
+		if (!(llHdl->pwmMask & chMask))
+			return(ERR_SUCCESS);
+
+		OSS_SpinLockAcquire(llHdl->osHdl, llHdl->outLock);
+		llHdl->pwmMask  &= ~chMask;
+		llHdl->pwmValue &= ~chMask;
+		OutputWrite(llHdl, M27_SRC_PWM, (u_int16)(llHdl->outShadow & ~chMask));
+		OSS_SpinLockRelease(llHdl->osHdl, llHdl->outLock);
+
+		if (!llHdl->pwmMask)
+			OSS_AlarmClear(llHdl->osHdl, llHdl->pwmAlarm);
+
+		return(ERR_SUCCESS);
+	}
+
+	/* first channel: start alarm, get real tick */
+	if (!llHdl->pwmMask) {
+		llHdl->pwmTicks     = 0;
+		llHdl->pwmElapsed   = 0;
+		llHdl->pwmMaxLate   = 0;
+		llHdl->pwmLate      = 0;
+		llHdl->pwmStartTick = OSS_TickGet(llHdl->osHdl);
+
+		if ((error = OSS_AlarmSet(llHdl->osHdl, llHdl->pwmAlarm,
+								  llHdl->pwmTick, TRUE, &realMsec)))
+			return(error);
+
+		llHdl->pwmTickMs = realMsec ? realMsec : llHdl->pwmTick;
+	}
+
+	/* alarm is running: take over the new settings */
+	llHdl->pwmPeriodMs[ch] = periodMs;
+	llHdl->pwmDuty[ch]     = duty;
+
+	/* convert to pwm ticks (rounded) */
+	period = (periodMs + llHdl->pwmTickMs/2) / llHdl->pwmTickMs;
+	if (period == 0)
+		period = 1;
+
+	OSS_SpinLockAcquire(llHdl->osHdl, llHdl->outLock);
+	llHdl->pwmPeriod[ch] = period;
+	llHdl->pwmOn[ch]     = (period * duty + 500) / 1000;
+	llHdl->pwmPhase[ch]  = 0;
+	llHdl->pwmMask      |= chMask;
+
+	/* recompute current state of all pwm channels */
+	llHdl->pwmValue = 0;
+	for (n=0; n<CH_NUMBER; n++)
+		if ((llHdl->pwmMask & (0x01 << n)) &&
+			(llHdl->pwmPhase[n] < llHdl->pwmOn[n]))
+			llHdl->pwmValue |= (0x01 << n);
+	OSS_SpinLockRelease(llHdl->osHdl, llHdl->outLock);
+
+	return(error);
+}
+
+/********************************* PwmStop **********************************
+ *
+ *  Description: Stop software PWM of all channels
+ *
+ *               The outputs keep their current state.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: llHdl		ll handle
+ *  Output.....: -
+ *  Globals....: -
+ ****************************************************************************/
+static void PwmStop(
+   LL_HANDLE    *llHdl
+)
+{
+	OSS_SpinLockAcquire(llHdl->osHdl, llHdl->outLock);
+	llHdl->pwmMask = 0;
+	OSS_SpinLockRelease(llHdl->osHdl, llHdl->outLock);
+
+	OSS_AlarmClear(llHdl->osHdl, llHdl->pwmAlarm);
+}
+
+/********************************* PwmAlarm *********************************
+ *
+ *  Description: PWM alarm routine (cyclic, every PWM tick)
+ *
+ *               Advances the phase of all PWM channels and writes the
+ *               merged output word with one register access.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: arg		ll handle
+ *  Output.....: -
+ *  Globals....: -
+ ****************************************************************************/
+static void PwmAlarm(
+   void *arg
+)
+{
+	LL_HANDLE *llHdl = (LL_HANDLE*)arg;
+	u_int32 n, now, late, tickMs;
+	u_int16 value = 0;
+
+	tickMs = (1000 + llHdl->tickRate - 1) / llHdl->tickRate;
+
+	OSS_SpinLockAcquire(llHdl->osHdl, llHdl->outLock);
+
+	if (!llHdl->pwmMask) {
+		OSS_SpinLockRelease(llHdl->osHdl, llHdl->outLock);
+		return;
+	}
+
+	/* timing statistics */
+	now = TicksToMs(llHdl, OSS_TickGet(llHdl->osHdl) - llHdl->pwmStartTick);
+	llHdl->pwmTicks++;
+	llHdl->pwmElapsed = now;
+
+	late = now - llHdl->pwmTicks * llHdl->pwmTickMs;
+	if ((int32)late > 0) {
+		if (late > llHdl->pwmMaxLate)
+			llHdl->pwmMaxLate = late;
+		if (late > tickMs)
+			llHdl->pwmLate++;
+	}
+
+	/* advance phases, merge channel states */
+	for (n=0; n<CH_NUMBER; n++) {
+		if (!(llHdl->pwmMask & (0x01 << n)))
+			continue;
+
+		if (++llHdl->pwmPhase[n] >= llHdl->pwmPeriod[n])
+			llHdl->pwmPhase[n] = 0;
+
+		if (llHdl->pwmPhase[n] < llHdl->pwmOn[n])
+			value |= (0x01 << n);
+	}
+	llHdl->pwmValue = value;
+
+	OutputWrite(llHdl, M27_SRC_PWM,
+				(u_int16)((llHdl->outShadow & ~llHdl->pwmMask) | value));
+
+	OSS_SpinLockRelease(llHdl->osHdl, llHdl->outLock);
+}
+
+/********************************* CmdList **********************************
+ *
+ *  Description: Execute a command list (M27_BLK_CMDLIST)
+ *
+ *               The commands are executed in order under the device
+ *               semaphore. Output commands write immediately, staged
+ *               changes are not affected. Busy-waits (M27_CMD_DELAY_US,
+ *               pulse width) are limited to PULSE_BUSY_MAX us per
+ *               command, longer delays must use M27_CMD_SLEEP_MS. The
+ *               sleeps of one list are limited to CMD_SLEEP_MAX ms in
+ *               total, since the semaphore is held meanwhile.
+ *
+ *               Execution stops at the first failing command, its error
+ *               is returned. Commands not executed get status -1.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: llHdl		ll handle
+ *               blk        block with M27_CMD array
+ *  Output.....: return     success (0) or error code
+ *  Globals....: -
+ ****************************************************************************/
+static int32 CmdList(
+   LL_HANDLE    *llHdl,
+   M_SG_BLOCK   *blk
+)
+{
+	M27_CMD *cmd = (M27_CMD*)blk->data;
+	u_int32 n, cmdNbr = blk->size / sizeof(M27_CMD);
+	u_int32 sleepMs = 0;
+	int32 error = ERR_SUCCESS;
+
+	if (cmdNbr == 0)
+		return(ERR_LL_USERBUF);
+
+	for (n=0; n<cmdNbr; n++, cmd++) {
+		if (error) {
+			cmd->status = -1;			/* not executed */
+			continue;
+		}
+
+		switch (cmd->op) {
+			case M27_CMD_WRITE:
+				OutputUpdate(llHdl, M27_SRC_CMDLIST, 0xffff,
+							 (u_int16)cmd->value, 0);
+				break;
+			case M27_CMD_SET:
+				OutputUpdate(llHdl, M27_SRC_CMDLIST, cmd->mask, 0xffff, 0);
+				break;
+			case M27_CMD_CLR:
+				OutputUpdate(llHdl, M27_SRC_CMDLIST, cmd->mask, 0x0000, 0);
+				break;
+			case M27_CMD_TOGGLE:
+				OutputUpdate(llHdl, M27_SRC_CMDLIST, 0x0000, 0x0000,
+							 cmd->mask);
+				break;
+			case M27_CMD_MASKED:
+				OutputUpdate(llHdl, M27_SRC_CMDLIST, cmd->mask,
+							 (u_int16)cmd->value, 0);
+				break;
+			case M27_CMD_DELAY_US:
+				if (cmd->value > PULSE_BUSY_MAX)
+					error = ERR_LL_ILL_PARAM;
+				else
+					OSS_MikroDelay(llHdl->osHdl, cmd->value);
+				break;
+			case M27_CMD_SLEEP_MS:
+				if (cmd->value > CMD_SLEEP_MAX - sleepMs) {
+					error = ERR_LL_ILL_PARAM;
+					break;
+				}
+				sleepMs += cmd->value;
+				OSS_Delay(llHdl->osHdl, cmd->value);
+				break;
+			case M27_CMD_PULSE:
+				if ((cmd->value == 0) || (cmd->value > PULSE_BUSY_MAX)) {
+					error = ERR_LL_ILL_PARAM;
+					break;
+				}
+				OutputUpdate(llHdl, M27_SRC_CMDLIST, cmd->mask, 0xffff, 0);
+				OSS_MikroDelay(llHdl->osHdl, cmd->value);
+				OutputUpdate(llHdl, M27_SRC_CMDLIST, cmd->mask, 0x0000, 0);
+				break;
+			case M27_CMD_READ:
+				cmd->result = OutputGet(llHdl);
+				break;
+			default:
+				error = ERR_LL_ILL_PARAM;
+		}
+
+		cmd->status = error;
+	}
+
+	return(error);
+}
+
+/******************************** PulseStart ********************************
+ *
+ *  Description: Fire a pulse or pulse train
+ *
+ *               Short pulses (up to PULSE_BUSY_MAX us in total) are
+ *               generated within the call with busy-waiting. Longer ones
+ *               are timed by the pulse alarm, edges are scheduled at
+ *               absolute times from the first rising edge.
+ *
+ *               'count' is limited to PULSE_COUNT_MAX, so the nr of
+ *               edges fits into u_int32.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: llHdl		ll handle
+ *               blk        block with M27_PULSE struct
+ *  Output.....: return     success (0) or error code
+ *  Globals....: -
+ ****************************************************************************/
+static int32 PulseStart(
+   LL_HANDLE    *llHdl,
+   M_SG_BLOCK   *blk
+)
+{
+	M27_PULSE *pulse = (M27_PULSE*)blk->data;
+	u_int32 n, count, realMsec;
+
+	if (blk->size < (int32)sizeof(M27_PULSE))
+		return(ERR_LL_USERBUF);
+
+	count = pulse->count ? pulse->count : 1;
+
+	if ( (pulse->mask == 0) || (pulse->width == 0) ||
+		 (count > PULSE_COUNT_MAX) ||
+		 ((count > 1) && (pulse->period <= pulse->width)) )
+		return(ERR_LL_ILL_PARAM);
+
+	if (llHdl->pulseRun)
+		return(ERR_LL_DEV_BUSY);
+
+	/* short pulse(s): busy-wait */
+	if ( (pulse->width <= PULSE_BUSY_MAX) &&
+		 ((count == 1) ||
+		  ((pulse->period <= PULSE_BUSY_MAX) &&
+		   (count - 1 <= (PULSE_BUSY_MAX - pulse->width) / pulse->period))) ) {
+		for (n=0; n<count; n++) {
+			if (n)
+				OSS_MikroDelay(llHdl->osHdl, pulse->period - pulse->width);
+			OutputUpdate(llHdl, M27_SRC_PULSE, pulse->mask, 0xffff, 0);
+			OSS_MikroDelay(llHdl->osHdl, pulse->width);
+			OutputUpdate(llHdl, M27_SRC_PULSE, pulse->mask, 0x0000, 0);
+		}
+		return(ERR_SUCCESS);
+	}
+
+	/* long pulse(s): alarm timed, first rising edge now */
+	OSS_SpinLockAcquire(llHdl->osHdl, llHdl->outLock);
+	llHdl->pulseMask      = pulse->mask;
+	llHdl->pulseWidthMs   = (pulse->width + 999) / 1000;
+	llHdl->pulsePeriodMs  = (pulse->period + 999) / 1000;
+	llHdl->pulseEdges     = 2 * count;
+	llHdl->pulseEdge      = 1;
+	llHdl->pulseStartTick = OSS_TickGet(llHdl->osHdl);
+	llHdl->pulseRun       = TRUE;
+	OutputWrite(llHdl, M27_SRC_PULSE,
+				(u_int16)(llHdl->outShadow | llHdl->pulseMask));
+	OSS_SpinLockRelease(llHdl->osHdl, llHdl->outLock);
+
+	return( OSS_AlarmSet(llHdl->osHdl, llHdl->pulseAlarm,
+						 llHdl->pulseWidthMs, FALSE, &realMsec) );
+}
+
+/********************************* PulseStop ********************************
+ *
+ *  Description: Abort pulse (train), reset the pulsed channels
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: llHdl		ll handle
+ *  Output.....: -
+ *  Globals....: -
+ ****************************************************************************/
+static void PulseStop(
+   LL_HANDLE    *llHdl
+)
+{
+	OSS_SpinLockAcquire(llHdl->osHdl, llHdl->outLock);
+	if (llHdl->pulseRun) {
+		llHdl->pulseRun = FALSE;
+		OutputWrite(llHdl, M27_SRC_PULSE,
+					(u_int16)(llHdl->outShadow & ~llHdl->pulseMask));
+	}
+	OSS_SpinLockRelease(llHdl->osHdl, llHdl->outLock);
+
+	OSS_AlarmClear(llHdl->osHdl, llHdl->pulseAlarm);
+}
+
+/******************************** PulseAlarm ********************************
+ *
+ *  Description: Pulse alarm routine
+ *
+ *               Applies all due edges and re-arms the alarm for the next
+ *               one. Edge e is due at (e/2)*period + (e%2)*width ms.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: arg		ll handle
+ *  Output.....: -
+ *  Globals....: -
+ ****************************************************************************/
+static void PulseAlarm(
+   void *arg
+)
+{
+	LL_HANDLE *llHdl = (LL_HANDLE*)arg;
+	u_int32 now, due, realMsec;
+
+	OSS_SpinLockAcquire(llHdl->osHdl, llHdl->outLock);
+
+	if (!llHdl->pulseRun) {
+		OSS_SpinLockRelease(llHdl->osHdl, llHdl->outLock);
+		return;
+	}
+
+	now = TicksToMs(llHdl, OSS_TickGet(llHdl->osHdl) - llHdl->pulseStartTick);
+
+	for (;;) {
+		/* all edges done? */
+		if (llHdl->pulseEdge >= llHdl->pulseEdges) {
+			llHdl->pulseRun = FALSE;
+			OSS_SpinLockRelease(llHdl->osHdl, llHdl->outLock);
+			return;
+		}
+
+		due = (llHdl->pulseEdge / 2) * llHdl->pulsePeriodMs +
+			  (llHdl->pulseEdge % 2) * llHdl->pulseWidthMs;
+
+		if ((int32)(due - now) > 0)
+			break;
+
+		/* odd edge: falling, even edge: rising */
+		if (llHdl->pulseEdge % 2)
+			OutputWrite(llHdl, M27_SRC_PULSE,
+						(u_int16)(llHdl->outShadow & ~llHdl->pulseMask));
+		else
+			OutputWrite(llHdl, M27_SRC_PULSE,
+						(u_int16)(llHdl->outShadow | llHdl->pulseMask));
+
+		llHdl->pulseEdge++;
+	}
+
+	OSS_SpinLockRelease(llHdl->osHdl, llHdl->outLock);
+
+	OSS_AlarmSet(llHdl->osHdl, llHdl->pulseAlarm, due - now, FALSE, &realMsec);
+}
+
+/********************************* Cleanup **********************************
+ *
+ *  Description: Close all handles, free memory and return error code
+ *		         NOTE: The ll handle is invalid after calling this function
+ *			   
+ *---------------------------------------------------------------------------
+ *  Input......: llHdl		ll handle
+ *               retCode    return value
+ *  Output.....: return	    retCode
+ *  Globals....: -
+ ****************************************************************************/
+static int32 Cleanup(
+   LL_HANDLE    *llHdl,
+   int32        retCode
+)
+{
+	int32 ch;
+
+    /*------------------------------+
+    |  close handles                |
+    +------------------------------*/
+	/* clean up desc */
+	if (llHdl->descHdl)
+		DESC_Exit(&llHdl->descHdl);
+
+	/* remove alarms */
+	if (llHdl->seqAlarm) {
+		OSS_AlarmClear(llHdl->osHdl, llHdl->seqAlarm);
+		OSS_AlarmRemove(llHdl->osHdl, &llHdl->seqAlarm);
+	}
+	if (llHdl->pwmAlarm) {
+		OSS_AlarmClear(llHdl->osHdl, llHdl->pwmAlarm);
+		OSS_AlarmRemove(llHdl->osHdl, &llHdl->pwmAlarm);
+	}
+	if (llHdl->pulseAlarm) {
+		OSS_AlarmClear(llHdl->osHdl, llHdl->pulseAlarm);
+		OSS_AlarmRemove(llHdl->osHdl, &llHdl->pulseAlarm);
+	}
+
+	/* remove locks */
+	if (llHdl->outLock)
+		OSS_SpinLockRemove(llHdl->osHdl, &llHdl->outLock);
+	if (llHdl->devSem)
+		OSS_SemRemove(llHdl->osHdl, &llHdl->devSem);
+	if (llHdl->genSem)
+		OSS_SemRemove(llHdl->osHdl, &llHdl->genSem);
+	for (ch=0; ch<CH_NUMBER; ch++)
+		if (llHdl->chSem[ch])
+			OSS_SemRemove(llHdl->osHdl, &llHdl->chSem[ch]);
+
+    /*------------------------------+
+    |  free memory                  |
+    +------------------------------*/
+	/* free sequence table */
+	if (llHdl->seqTbl)
+		OSS_MemFree(llHdl->osHdl, (int8*)llHdl->seqTbl, llHdl->seqTblAlloc);
+
+	/* free trace buffer */
+	if (llHdl->trcBuf)
+		OSS_MemFree(llHdl->osHdl, (int8*)llHdl->trcBuf, llHdl->trcAlloc);
+
+	/* cleanup debug */
+	DBGEXIT((&DBH));
 
-    /*------------------------------+
-    |  free memory                  |
-    +------------------------------*/
     /* free my handle */
     OSS_MemFree(llHdl->osHdl, (int8*)llHdl, llHdl->memAlloc);
 
@@ -0,0 +1,43 @@
+/***********************  I n c l u d e  -  F i l e  ************************
+ *
+ *         Name: dbg.h
+ *
+ *  Description: Debug macros (no output in the simulation)
+ *
+ *               Host simulation only: minimal replacement of the MDIS
+ *               header of the same name, just enough to build the M27
+ *               driver and tools on a plain Linux host (see ../../Makefile).
+ *
+ *---------------------------------------------------------------------------
+ * Copyright 2026, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _DBG_H
+#define _DBG_H
+
+typedef void DBG_HANDLE;
+
+#define DBGINIT(x)
+#define DBGEXIT(x)
+#define DBGWRT_1(x)
+#define DBGWRT_2(x)
+#define DBGWRT_3(x)
+#define DBGWRT_ERR(x)
+#define IDBGWRT_1(x)
+#define IDBGWRT_2(x)
+
+#endif /* _DBG_H */
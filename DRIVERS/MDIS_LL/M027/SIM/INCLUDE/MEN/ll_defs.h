@@ -0,0 +1,53 @@
+/***********************  I n c l u d e  -  F i l e  ************************
+ *
+ *         Name: ll_defs.h
+ *
+ *  Description: Low-level driver definitions
+ *
+ *               Host simulation only: minimal replacement of the MDIS
+ *               header of the same name, just enough to build the M27
+ *               driver and tools on a plain Linux host (see ../../Makefile).
+ *
+ *---------------------------------------------------------------------------
+ * Copyright 2026, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _LL_DEFS_H
+#define _LL_DEFS_H
+
+/* irq return codes */
+#define LL_IRQ_DEVICE			0
+#define LL_IRQ_DEV_NOT			1
+#define LL_IRQ_UNKNOWN			2
+
+/* info codes */
+#define LL_INFO_HW_CHARACTER	0x01
+#define LL_INFO_ADDRSPACE_COUNT	0x02
+#define LL_INFO_ADDRSPACE		0x03
+#define LL_INFO_IRQ				0x04
+#define LL_INFO_LOCKMODE		0x05
+
+/* process lock modes */
+#define LL_LOCK_NONE			0
+#define LL_LOCK_CALL			1
+#define LL_LOCK_CHAN			2
+
+#ifndef _NO_LL_HANDLE
+	typedef void LL_HANDLE;
+#endif
+
+#endif /* _LL_DEFS_H */
@@ -0,0 +1,45 @@
+/***********************  I n c l u d e  -  F i l e  ************************
+ *
+ *         Name: maccess.h
+ *
+ *  Description: Hardware access macros, routed to the M27 register model
+ *
+ *               Host simulation only: minimal replacement of the MDIS
+ *               header of the same name, just enough to build the M27
+ *               driver and tools on a plain Linux host (see ../../Makefile).
+ *
+ *---------------------------------------------------------------------------
+ * Copyright 2026, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _MACCESS_H
+#define _MACCESS_H
+
+/* MACCESS is a pointer to the simulated M-Module */
+typedef struct M27SIM_HW *MACCESS;
+
+extern u_int16 M27SIM_Read16(MACCESS ma, u_int32 offs);
+extern void M27SIM_Write16(MACCESS ma, u_int32 offs, u_int16 val);
+
+#define MREAD_D16(ma,offs)			M27SIM_Read16((ma),(offs))
+#define MWRITE_D16(ma,offs,val)		M27SIM_Write16((ma),(offs),(u_int16)(val))
+#define MSETMASK_D16(ma,offs,m) \
+	MWRITE_D16(ma,offs,MREAD_D16(ma,offs) | (m))
+#define MCLRMASK_D16(ma,offs,m) \
+	MWRITE_D16(ma,offs,MREAD_D16(ma,offs) & ~(m))
+
+#endif /* _MACCESS_H */
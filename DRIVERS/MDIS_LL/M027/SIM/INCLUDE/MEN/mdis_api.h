@@ -0,0 +1,89 @@
+/***********************  I n c l u d e  -  F i l e  ************************
+ *
+ *         Name: mdis_api.h
+ *
+ *  Description: MDIS user interface (status codes, M_xxx functions)
+ *
+ *               Host simulation only: minimal replacement of the MDIS
+ *               header of the same name, just enough to build the M27
+ *               driver and tools on a plain Linux host (see ../../Makefile).
+ *
+ *---------------------------------------------------------------------------
+ * Copyright 2026, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _MDIS_API_H
+#define _MDIS_API_H
+
+#ifdef __cplusplus
+	extern "C" {
+#endif
+
+/* status code offsets */
+#define M_MK_OF				0x00000000
+#define M_LL_OF				0x00000100
+#define M_DEV_OF			0x00000200
+#define M_MK_BLK_OF			0x80000000
+#define M_LL_BLK_OF			0x80000100
+#define M_DEV_BLK_OF		0x80000200
+#define M_BLK_CODE(c)		((u_int32)(c) & 0x80000000)
+
+/* mdis kernel status codes */
+#define M_MK_IRQ_ENABLE		M_MK_OF+0x01
+#define M_MK_IRQ_COUNT		M_MK_OF+0x02
+#define M_MK_CH_CURRENT		M_MK_OF+0x03
+#define M_MK_IO_MODE		M_MK_OF+0x04
+#define M_MK_BLK_REV_ID		M_MK_BLK_OF+0x01
+
+/* low-level driver status codes */
+#define M_LL_DEBUG_LEVEL	M_LL_OF+0x01
+#define M_LL_CH_NUMBER		M_LL_OF+0x02
+#define M_LL_CH_DIR			M_LL_OF+0x03
+#define M_LL_CH_LEN			M_LL_OF+0x04
+#define M_LL_CH_TYP			M_LL_OF+0x05
+#define M_LL_IRQ_COUNT		M_LL_OF+0x06
+#define M_LL_ID_CHECK		M_LL_OF+0x07
+#define M_LL_ID_SIZE		M_LL_OF+0x08
+#define M_LL_BLK_ID_DATA	M_LL_BLK_OF+0x01
+
+/* channel direction/type */
+#define M_CH_IN				0
+#define M_CH_OUT			1
+#define M_CH_INOUT			2
+#define M_CH_BINARY			1
+
+/* block status data */
+typedef struct {
+	int32	size;
+	void	*data;
+} M_SG_BLOCK;
+
+extern MDIS_PATH M_open(const char *device);
+extern int32 M_close(MDIS_PATH path);
+extern int32 M_read(MDIS_PATH path, int32 *valueP);
+extern int32 M_write(MDIS_PATH path, int32 value);
+extern int32 M_getstat(MDIS_PATH path, int32 code, int32 *dataP);
+extern int32 M_setstat(MDIS_PATH path, int32 code, INT32_OR_64 data);
+extern int32 M_getblock(MDIS_PATH path, u_int8 *buffer, int32 length);
+extern int32 M_setblock(MDIS_PATH path, const u_int8 *buffer, int32 length);
+extern char *M_errstring(int32 errCode);
+
+#ifdef __cplusplus
+	}
+#endif
+
+#endif /* _MDIS_API_H */
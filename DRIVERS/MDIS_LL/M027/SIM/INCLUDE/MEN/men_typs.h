@@ -0,0 +1,57 @@
+/***********************  I n c l u d e  -  F i l e  ************************
+ *
+ *         Name: men_typs.h
+ *
+ *  Description: System dependent type definitions
+ *
+ *               Host simulation only: minimal replacement of the MDIS
+ *               header of the same name, just enough to build the M27
+ *               driver and tools on a plain Linux host (see ../../Makefile).
+ *
+ *---------------------------------------------------------------------------
+ * Copyright 2026, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _MEN_TYPS_H
+#define _MEN_TYPS_H
+
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdint.h>
+
+typedef int8_t		int8;
+typedef uint8_t		u_int8;
+typedef int16_t		int16;
+typedef uint16_t	u_int16;
+typedef int32_t		int32;
+typedef uint32_t	u_int32;
+typedef int64_t		int64;
+typedef uint64_t	u_int64;
+
+#define INT32_OR_64		intptr_t
+#define U_INT32_OR_64	uintptr_t
+typedef INT32_OR_64		MDIS_PATH;
+
+#ifndef TRUE
+#	define TRUE		1
+#	define FALSE	0
+#endif
+
+#define MENT_STR(x)		#x
+#define MENT_XSTR(x)	MENT_STR(x)
+
+#endif /* _MEN_TYPS_H */
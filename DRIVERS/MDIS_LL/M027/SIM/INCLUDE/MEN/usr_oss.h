@@ -0,0 +1,47 @@
+/***********************  I n c l u d e  -  F i l e  ************************
+ *
+ *         Name: usr_oss.h
+ *
+ *  Description: User mode operating system services
+ *
+ *               Host simulation only: minimal replacement of the MDIS
+ *               header of the same name, just enough to build the M27
+ *               driver and tools on a plain Linux host (see ../../Makefile).
+ *
+ *---------------------------------------------------------------------------
+ * Copyright 2026, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _USR_OSS_H
+#define _USR_OSS_H
+
+#ifdef __cplusplus
+	extern "C" {
+#endif
+
+extern u_int32 UOS_ErrnoGet(void);
+extern u_int32 UOS_ErrnoSet(u_int32 errCode);
+extern int32 UOS_Delay(u_int32 msec);
+extern u_int32 UOS_MsecTimerGet(void);
+extern int32 UOS_KeyPressed(void);
+extern int32 UOS_KeyWait(void);
+
+#ifdef __cplusplus
+	}
+#endif
+
+#endif /* _USR_OSS_H */
@@ -0,0 +1,38 @@
+/***********************  I n c l u d e  -  F i l e  ************************
+ *
+ *         Name: usr_utl.h
+ *
+ *  Description: User mode utilities (command line options)
+ *
+ *               Host simulation only: minimal replacement of the MDIS
+ *               header of the same name, just enough to build the M27
+ *               driver and tools on a plain Linux host (see ../../Makefile).
+ *
+ *---------------------------------------------------------------------------
+ * Copyright 2026, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _USR_UTL_H
+#define _USR_UTL_H
+
+#define UTL_TSTOPT(opt)				UTL_Tstopt(argc,argv,opt)
+#define UTL_ILLIOPT(opts,errstr)	UTL_Illiopt(argc,argv,opts,errstr)
+
+extern char *UTL_Tstopt(int argc, char **argv, char *option);
+extern char *UTL_Illiopt(int argc, char **argv, char *opts, char *errstr);
+
+#endif /* _USR_UTL_H */
@@ -0,0 +1,255 @@
+/*********************  P r o g r a m  -  M o d u l e ***********************
+ *
+ *         Name: m27_hpptest.cpp
+ *      Project: M27 host simulation
+ *
+ *  Description: Functional test of the C++ headers on the simulated
+ *               M-Module
+ *
+ *               Runs the m27::Path wrapper (m27.hpp) and the scheduler
+ *               (m27_sched.hpp) against the simulated device and checks
+ *               the resulting register contents and access counts. The
+ *               scheduler runs on a virtual clock, so the firing ticks
+ *               are deterministic.
+ *               Exits with 0 if all checks passed.
+ *
+ *     Required: libm27sim.a
+ *     Switches: -
+ *
+ *---------------------------------------------------------------------------
+ * Copyright 2026, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <vector>
+#include <MEN/men_typs.h>
+#include <MEN/mdis_api.h>
+#include <MEN/usr_oss.h>
+#include <MEN/m27.hpp>
+#include <MEN/m27_sched.hpp>
+#include "m27_sim.h"
+
+/*-----------------------------------------+
+|  DEFINES                                 |
++-----------------------------------------*/
+#define DEVICE		"m27_sim"
+
+/* check condition, count failures */
+#define CHECK(cond) \
+	do { \
+		G_checks++; \
+		if (!(cond)) { \
+			G_fails++; \
+			printf("*** %s:%d: check failed: %s\n", \
+				   __FILE__, __LINE__, #cond); \
+		} \
+	} while (0)
+
+/*-----------------------------------------+
+|  TYPEDEFS                                |
++-----------------------------------------*/
+/* virtual time: sleeping advances the time immediately */
+class VirtualClock : public m27::Clock {
+public:
+	VirtualClock() : t_(1000000000) {}
+
+	u_int64 now() noexcept override { return t_; }
+	void sleepUntil(u_int64 timeNs) override {
+		wakes.push_back(timeNs);
+		if (timeNs > t_)
+			t_ = timeNs;
+	}
+
+	std::vector<u_int64> wakes;		/* sleepUntil() times */
+
+private:
+	u_int64 t_;
+};
+
+/*-----------------------------------------+
+|  GLOBALS                                 |
++-----------------------------------------*/
+static int G_checks;
+static int G_fails;
+
+/*-----------------------------------------+
+|  PROTOTYPES                              |
++-----------------------------------------*/
+static void TestStaging(m27::Path &path, M27SIM_HW *hw);
+static void TestScheduler(m27::Path &path, M27SIM_HW *hw);
+
+/********************************* main *************************************
+ *
+ *  Description: Program main function
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: -
+ *  Output.....: return 0 (all checks passed) | 1
+ *  Globals....: -
+ ****************************************************************************/
+int main(void)
+{
+	try {
+		m27::Path path(DEVICE);
+		M27SIM_HW *hw = M27SIM_DevHw(DEVICE);
+
+		TestStaging(path, hw);
+		TestScheduler(path, hw);
+	}
+	catch (const std::exception &e) {
+		G_fails++;
+		printf("*** %s\n", e.what());
+	}
+
+	printf("%d checks, %d failed\n", G_checks, G_fails);
+	return(G_fails ? 1 : 0);
+}
+
+/******************************* TestStaging ********************************
+ *
+ *  Description: Staged updates of the wrapper, commit and abort
+ *
+ ****************************************************************************/
+static void TestStaging(m27::Path &path, M27SIM_HW *hw)
+{
+	const m27::Channel ch0(0), ch3(3), ch4(4);
+	m27::Path other(DEVICE);
+	u_int32 wr;
+
+	path.clear(m27::Mask::all());
+	wr = hw->wrCount;
+
+	/* staged updates don't reach the hardware */
+	path.stageSet(ch3);
+	path.stage(ch4, true);
+	path.stageClear(ch3);
+	CHECK(path.staged() == m27::Mask(0x0018));
+	CHECK(path.read() == m27::Mask());
+	CHECK(hw->wrCount == wr);
+
+	/* other writes go to the hardware immediately */
+	other.write(ch0, true);
+	CHECK(hw->reg[0] == 0x0001);
+
+	/* abort discards the staged updates */
+	path.abort();
+	CHECK(path.staged() == m27::Mask());
+	path.commit();
+	CHECK(path.read() == m27::Mask(ch0));
+	CHECK(hw->wrCount == wr + 1);
+
+	/* commit writes the staged channels with one access */
+	path.stage(m27::Mask(0xff00), m27::Mask(0x1200));
+	path.stage(ch4, true);
+	path.commit();
+	CHECK(hw->reg[0] == 0x1211);
+	CHECK(hw->wrCount == wr + 2);
+
+	path.clear(m27::Mask::all());
+	CHECK(hw->reg[0] == 0x0000);
+}
+
+/****************************** TestScheduler *******************************
+ *
+ *  Description: Scheduler changes fire on their tick at every wheel level
+ *
+ *               The ticks lie on and next to the level boundaries
+ *               (256^n), beyond 2^32 ticks the changes are parked in
+ *               level 3. In one run() the scheduler must wake up exactly
+ *               on these ticks. Stepwise, each change sets its own
+ *               channel, which must be reset one tick before and set on
+ *               its tick.
+ *
+ ****************************************************************************/
+static void TestScheduler(m27::Path &path, M27SIM_HW *hw)
+{
+	static const u_int64 tick[] = {
+		1, 255, 256, 257, 65535, 65536, 65537, (u_int64)1 << 24,
+		((u_int64)1 << 24) + 1, ((u_int64)1 << 32) - 1, (u_int64)1 << 32,
+		((u_int64)1 << 32) + 256, ((u_int64)3 << 32) + 65537
+	};
+	static const int EVENTS = sizeof(tick) / sizeof(tick[0]);
+	VirtualClock clock;
+	u_int64 start, t;
+	u_int32 wr;
+	int n, dev;
+
+	path.clear(m27::Mask::all());
+
+	/* one run: wake-ups on the change ticks only */
+	{
+		m27::Scheduler sched(1, clock);
+
+		start = clock.now();
+		dev = sched.add(path);
+		for (n=0; n<EVENTS; n++)
+			sched.set(start + tick[n] * 1000, dev, m27::Channel(n));
+		sched.run(start + (tick[EVENTS-1] + 1000) * 1000);
+
+		CHECK(clock.wakes.size() == (size_t)EVENTS + 1);
+		for (n=0; n<EVENTS && n<(int)clock.wakes.size(); n++)
+			CHECK(clock.wakes[n] == start + tick[n] * 1000);
+		CHECK(sched.pending() == 0);
+		CHECK(hw->reg[0] == (u_int16)((1 << EVENTS) - 1));
+	}
+
+	/* stepwise: channels change on their tick, not before */
+	path.clear(m27::Mask::all());
+	wr = hw->wrCount;
+
+	m27::Scheduler sched(1, clock);
+	start = clock.now();
+	dev = sched.add(path);
+	CHECK(sched.tickNs() == 1000);
+
+	/* schedule in reverse order: order in the wheel doesn't matter */
+	for (n=EVENTS-1; n>=0; n--)
+		sched.set(start + tick[n] * 1000, dev, m27::Channel(n));
+	CHECK(sched.pending() == (u_int32)EVENTS);
+
+	for (n=0; n<EVENTS; n++) {
+		sched.run(start + (tick[n] - 1) * 1000);
+		CHECK(hw->reg[0] == (u_int16)((1 << n) - 1));
+		sched.run(start + tick[n] * 1000);
+		CHECK(hw->reg[0] == (u_int16)((1 << (n + 1)) - 1));
+	}
+	CHECK(sched.pending() == 0);
+	CHECK(sched.stats().events == (u_int64)EVENTS);
+	CHECK(sched.stats().writes == (u_int64)EVENTS);
+	CHECK(sched.stats().jitterMaxNs == 0);
+	CHECK(hw->wrCount == wr + EVENTS);
+
+	/* from an unaligned tick, changes of one tick are merged */
+	t = (clock.now() - start) / 1000 + 3;
+	sched.clear(start + (t + ((u_int64)1 << 32) + 300) * 1000, dev,
+				m27::Channel(0));
+	sched.clear(start + (t + ((u_int64)1 << 32) + 300) * 1000, dev,
+				m27::Channel(1));
+	sched.clear(start + (t + 70000) * 1000, dev, m27::Channel(2));
+	sched.run(start + (t + 69999) * 1000);
+	CHECK(hw->reg[0] == 0x1fff);
+	sched.run(start + (t + 70000) * 1000);
+	CHECK(hw->reg[0] == 0x1ffb);
+	sched.run(start + (t + ((u_int64)1 << 32) + 299) * 1000);
+	CHECK(hw->reg[0] == 0x1ffb);
+	sched.run(start + (t + ((u_int64)1 << 32) + 300) * 1000);
+	CHECK(hw->reg[0] == 0x1ff8);
+	CHECK(sched.stats().writes == (u_int64)EVENTS + 2);
+
+	path.clear(m27::Mask::all());
+	CHECK(hw->reg[0] == 0x0000);
+}
@@ -0,0 +1,622 @@
+/*********************  P r o g r a m  -  M o d u l e ***********************
+ *
+ *         Name: m27_sim.c
+ *      Project: M27 host simulation
+ *
+ *  Description: Register model, ID PROM and OS services for running the
+ *               M27 low-level driver on a plain Linux host
+ *
+ *               The M-Module is modelled in memory (M27SIM_HW). MACCESS
+ *               points to the model, MREAD_D16/MWRITE_D16 and m_read
+ *               count every access and can inject a per-access latency
+ *               (busy-wait), so performance work can be measured
+ *               reproducibly without hardware.
+ *
+ *               OSS alarms run in their own thread, spin locks and
+ *               semaphores are based on pthread mutexes/conditions.
+ *               One OSS tick is one millisecond.
+ *
+ *     Required: libpthread
+ *     Switches: -
+ *
+ *---------------------------------------------------------------------------
+ * Copyright 2026, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <MEN/men_typs.h>
+#include <MEN/maccess.h>
+#include <MEN/oss.h>
+#include <MEN/desc.h>
+#include <MEN/modcom.h>
+#include <MEN/mdis_err.h>
+#include "m27_sim.h"
+
+/*-----------------------------------------+
+|  DEFINES                                 |
++-----------------------------------------*/
+#define MOD_ID_MAGIC		0x5346		/* id prom magic word */
+
+/*-----------------------------------------+
+|  TYPEDEFS                                |
++-----------------------------------------*/
+struct OSS_SEM_HANDLE {
+	pthread_mutex_t	mtx;
+	pthread_cond_t	cond;
+	int32			type;
+	int32			count;
+};
+
+struct OSS_SPINL_HANDLE {
+	pthread_mutex_t	mtx;
+};
+
+struct OSS_ALARM_HANDLE {
+	pthread_t		thread;
+	pthread_mutex_t	mtx;
+	pthread_cond_t	cond;
+	void			(*funct)(void *arg);
+	void			*arg;
+	int				armed;			/* alarm set */
+	int				quit;			/* remove requested */
+	u_int32			cyclicNs;		/* cyclic period (0=single) */
+	struct timespec	due;			/* next expiry */
+};
+
+struct DESC_HANDLE {
+	DESC_SPEC		*spec;
+};
+
+/*-----------------------------------------+
+|  PROTOTYPES                              |
++-----------------------------------------*/
+static void NsDelay(u_int32 ns);
+static void TsAddNs(struct timespec *ts, u_int64 ns);
+static void *AlarmThread(void *arg);
+
+/*-----------------------------------------+
+|  GLOBALS                                 |
++-----------------------------------------*/
+static u_int32 G_alarmFail;			/* nr of OSS_AlarmSet() to fail */
+
+/*****************************************************************************
+ *                         R E G I S T E R   M O D E L
+ ****************************************************************************/
+
+/****************************** M27SIM_HwInit *******************************
+ *
+ *  Description: Initialize a simulated M-Module
+ *
+ *               Registers are cleared, the ID PROM gets the magic word
+ *               and the module id, latencies are zero.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: hw		simulated module
+ *               modId  module id (27, 28 or 81 for a valid M27)
+ *  Output.....: -
+ *  Globals....: -
+ ****************************************************************************/
+void M27SIM_HwInit(M27SIM_HW *hw, u_int16 modId)
+{
+	int n;
+
+	memset(hw, 0, sizeof(*hw));
+
+	hw->prom[0] = MOD_ID_MAGIC;
+	hw->prom[1] = modId;
+	hw->prom[2] = 0x0100;			/* revision */
+	for (n=3; n<M27SIM_PROM_SIZE/2; n++)
+		hw->prom[n] = (u_int16)(0x1111 * n);
+}
+
+/**************************** M27SIM_LatencySet *****************************
+ *
+ *  Description: Set per-access latencies of a simulated M-Module
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: hw		simulated module
+ *               rdNs   register read latency [ns]
+ *               wrNs   register write latency [ns]
+ *               promNs ID PROM word read latency [ns]
+ *  Output.....: -
+ *  Globals....: -
+ ****************************************************************************/
+void M27SIM_LatencySet(M27SIM_HW *hw, u_int32 rdNs, u_int32 wrNs,
+					   u_int32 promNs)
+{
+	hw->rdLatNs   = rdNs;
+	hw->wrLatNs   = wrNs;
+	hw->promLatNs = promNs;
+}
+
+/************************** M27SIM_LatencyFromEnv ***************************
+ *
+ *  Description: Set latencies from environment variable M27SIM_LAT
+ *
+ *               Format: M27SIM_LAT=<rdNs>,<wrNs>[,<promNs>]
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: hw		simulated module
+ *  Output.....: -
+ *  Globals....: -
+ ****************************************************************************/
+void M27SIM_LatencyFromEnv(M27SIM_HW *hw)
+{
+	unsigned rd=0, wr=0, prom=0;
+	char *env = getenv("M27SIM_LAT");
+
+	if (env && sscanf(env, "%u,%u,%u", &rd, &wr, &prom) >= 2)
+		M27SIM_LatencySet(hw, rd, wr, prom);
+}
+
+/****************************** M27SIM_Read16 *******************************
+ *
+ *  Description: MREAD_D16 of the simulated M-Module
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: ma		simulated module
+ *               offs   register offset
+ *  Output.....: return register value
+ *  Globals....: -
+ ****************************************************************************/
+u_int16 M27SIM_Read16(MACCESS ma, u_int32 offs)
+{
+	__sync_fetch_and_add(&ma->rdCount, 1);
+	NsDelay(ma->rdLatNs);
+
+	return(__sync_fetch_and_add(&ma->reg[(offs % M27SIM_REG_SIZE) / 2], 0));
+}
+
+/****************************** M27SIM_Write16 ******************************
+ *
+ *  Description: MWRITE_D16 of the simulated M-Module
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: ma		simulated module
+ *               offs   register offset
+ *               val    value to write
+ *  Output.....: -
+ *  Globals....: -
+ ****************************************************************************/
+void M27SIM_Write16(MACCESS ma, u_int32 offs, u_int16 val)
+{
+	__sync_fetch_and_add(&ma->wrCount, 1);
+	NsDelay(ma->wrLatNs);
+
+	__atomic_store_n(&ma->reg[(offs % M27SIM_REG_SIZE) / 2], val,
+					 __ATOMIC_SEQ_CST);
+}
+
+/********************************** m_read **********************************
+ *
+ *  Description: Read one word of the simulated ID PROM
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: addr	simulated module (MACCESS)
+ *               index  word index
+ *  Output.....: return word
+ *  Globals....: -
+ ****************************************************************************/
+int m_read(U_INT32_OR_64 addr, int index)
+{
+	M27SIM_HW *hw = (M27SIM_HW*)addr;
+
+	__sync_fetch_and_add(&hw->promCount, 1);
+	NsDelay(hw->promLatNs);
+
+	return(hw->prom[index % (M27SIM_PROM_SIZE/2)]);
+}
+
+/*****************************************************************************
+ *                         D E S C R I P T O R
+ ****************************************************************************/
+
+int32 DESC_Init(DESC_SPEC *descSpec, OSS_HANDLE *osHdl, DESC_HANDLE **descHdlP)
+{
+	if ((*descHdlP = (DESC_HANDLE*)malloc(sizeof(DESC_HANDLE))) == NULL)
+		return(ERR_OSS_MEM_ALLOC);
+
+	(*descHdlP)->spec = descSpec;
+	return(ERR_SUCCESS);
+}
+
+int32 DESC_GetUInt32(DESC_HANDLE *descHdl, u_int32 defVal, u_int32 *valueP,
+					 char *keyFmt, ...)
+{
+	DESC_SPEC *spec;
+	char key[64];
+	va_list ap;
+
+	va_start(ap, keyFmt);
+	vsnprintf(key, sizeof(key), keyFmt, ap);
+	va_end(ap);
+
+	*valueP = defVal;
+
+	for (spec=descHdl->spec; spec && spec->key; spec++) {
+		if (strcmp(spec->key, key) == 0) {
+			*valueP = spec->value;
+			return(ERR_SUCCESS);
+		}
+	}
+	return(ERR_DESC_KEY_NOTFOUND);
+}
+
+int32 DESC_DbgLevelSet(DESC_HANDLE *descHdl, u_int32 dbgLevel)
+{
+	return(ERR_SUCCESS);
+}
+
+int32 DESC_Exit(DESC_HANDLE **descHdlP)
+{
+	free(*descHdlP);
+	*descHdlP = NULL;
+	return(ERR_SUCCESS);
+}
+
+char *DESC_Ident(void)
+{
+	return("DESC - M27 host simulation");
+}
+
+/*****************************************************************************
+ *                         O S   S E R V I C E S
+ ****************************************************************************/
+
+char *OSS_Ident(void)
+{
+	return("OSS - M27 host simulation");
+}
+
+void *OSS_MemGet(OSS_HANDLE *osHdl, u_int32 size, u_int32 *gotsizeP)
+{
+	void *mem = malloc(size);
+
+	*gotsizeP = mem ? size : 0;
+	return(mem);
+}
+
+int32 OSS_MemFree(OSS_HANDLE *osHdl, void *addr, u_int32 size)
+{
+	free(addr);
+	return(ERR_SUCCESS);
+}
+
+void OSS_MemFill(OSS_HANDLE *osHdl, u_int32 size, char *adr, int8 value)
+{
+	memset(adr, value, size);
+}
+
+void OSS_MemCopy(OSS_HANDLE *osHdl, u_int32 size, char *src, char *dest)
+{
+	memcpy(dest, src, size);
+}
+
+int32 OSS_Delay(OSS_HANDLE *osHdl, int32 msec)
+{
+	usleep(msec * 1000);
+	return(msec);
+}
+
+int32 OSS_MikroDelayInit(OSS_HANDLE *osHdl)
+{
+	return(ERR_SUCCESS);
+}
+
+int32 OSS_MikroDelay(OSS_HANDLE *osHdl, u_int32 usec)
+{
+	NsDelay(usec * 1000);
+	return(ERR_SUCCESS);
+}
+
+u_int32 OSS_TickRateGet(OSS_HANDLE *osHdl)
+{
+	return(1000);
+}
+
+u_int32 OSS_TickGet(OSS_HANDLE *osHdl)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return((u_int32)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000));
+}
+
+/*--------------------------------------+
+|   semaphores                          |
++--------------------------------------*/
+int32 OSS_SemCreate(OSS_HANDLE *osHdl, int32 semType, int32 initVal,
+					OSS_SEM_HANDLE **semP)
+{
+	OSS_SEM_HANDLE *sem;
+
+	if ((sem = (OSS_SEM_HANDLE*)calloc(1, sizeof(*sem))) == NULL)
+		return(ERR_OSS_MEM_ALLOC);
+
+	pthread_mutex_init(&sem->mtx, NULL);
+	pthread_cond_init(&sem->cond, NULL);
+	sem->type  = semType;
+	sem->count = (semType == OSS_SEM_BIN && initVal) ? 1 : initVal;
+
+	*semP = sem;
+	return(ERR_SUCCESS);
+}
+
+int32 OSS_SemRemove(OSS_HANDLE *osHdl, OSS_SEM_HANDLE **semP)
+{
+	pthread_mutex_destroy(&(*semP)->mtx);
+	pthread_cond_destroy(&(*semP)->cond);
+	free(*semP);
+	*semP = NULL;
+	return(ERR_SUCCESS);
+}
+
+int32 OSS_SemWait(OSS_HANDLE *osHdl, OSS_SEM_HANDLE *sem, int32 msec)
+{
+	struct timespec due;
+	int32 error = ERR_SUCCESS;
+
+	clock_gettime(CLOCK_REALTIME, &due);
+	if (msec > 0)
+		TsAddNs(&due, (u_int64)msec * 1000000);
+
+	pthread_mutex_lock(&sem->mtx);
+	while (sem->count == 0) {
+		if (msec == OSS_SEM_NOWAIT ||
+			(msec > 0 &&
+			 pthread_cond_timedwait(&sem->cond, &sem->mtx, &due) == ETIMEDOUT)) {
+			if (sem->count == 0)
+				error = ERR_OSS_TIMEOUT;
+			break;
+		}
+		if (msec < 0)
+			pthread_cond_wait(&sem->cond, &sem->mtx);
+	}
+	if (error == ERR_SUCCESS)
+		sem->count--;
+	pthread_mutex_unlock(&sem->mtx);
+
+	return(error);
+}
+
+int32 OSS_SemSignal(OSS_HANDLE *osHdl, OSS_SEM_HANDLE *sem)
+{
+	pthread_mutex_lock(&sem->mtx);
+	if (sem->type == OSS_SEM_BIN)
+		sem->count = 1;
+	else
+		sem->count++;
+	pthread_cond_signal(&sem->cond);
+	pthread_mutex_unlock(&sem->mtx);
+
+	return(ERR_SUCCESS);
+}
+
+/*--------------------------------------+
+|   spin locks                          |
++--------------------------------------*/
+int32 OSS_SpinLockCreate(OSS_HANDLE *osHdl, OSS_SPINL_HANDLE **spinlP)
+{
+	if ((*spinlP = (OSS_SPINL_HANDLE*)calloc(1, sizeof(**spinlP))) == NULL)
+		return(ERR_OSS_MEM_ALLOC);
+
+	pthread_mutex_init(&(*spinlP)->mtx, NULL);
+	return(ERR_SUCCESS);
+}
+
+int32 OSS_SpinLockRemove(OSS_HANDLE *osHdl, OSS_SPINL_HANDLE **spinlP)
+{
+	pthread_mutex_destroy(&(*spinlP)->mtx);
+	free(*spinlP);
+	*spinlP = NULL;
+	return(ERR_SUCCESS);
+}
+
+int32 OSS_SpinLockAcquire(OSS_HANDLE *osHdl, OSS_SPINL_HANDLE *spinl)
+{
+	pthread_mutex_lock(&spinl->mtx);
+	return(ERR_SUCCESS);
+}
+
+int32 OSS_SpinLockRelease(OSS_HANDLE *osHdl, OSS_SPINL_HANDLE *spinl)
+{
+	pthread_mutex_unlock(&spinl->mtx);
+	return(ERR_SUCCESS);
+}
+
+/*--------------------------------------+
+|   alarms                              |
++--------------------------------------*/
+/****************************** M27SIM_AlarmFail ****************************
+ *
+ *  Description: Let the next OSS_AlarmSet() calls fail
+ *
+ *               Used to test the error paths of the alarm users.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: count		nr of calls to fail with ERR_OSS_BUSY_RESOURCE
+ *  Output.....: -
+ *  Globals....: G_alarmFail
+ ****************************************************************************/
+void M27SIM_AlarmFail(u_int32 count)
+{
+	G_alarmFail = count;
+}
+
+int32 OSS_AlarmCreate(OSS_HANDLE *osHdl, void (*funct)(void *arg), void *arg,
+					  OSS_ALARM_HANDLE **alarmP)
+{
+	OSS_ALARM_HANDLE *alm;
+	pthread_condattr_t attr;
+
+	if ((alm = (OSS_ALARM_HANDLE*)calloc(1, sizeof(*alm))) == NULL)
+		return(ERR_OSS_MEM_ALLOC);
+
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_mutex_init(&alm->mtx, NULL);
+	pthread_cond_init(&alm->cond, &attr);
+	alm->funct = funct;
+	alm->arg   = arg;
+
+	if (pthread_create(&alm->thread, NULL, AlarmThread, alm)) {
+		free(alm);
+		return(ERR_OSS_MEM_ALLOC);
+	}
+
+	*alarmP = alm;
+	return(ERR_SUCCESS);
+}
+
+int32 OSS_AlarmRemove(OSS_HANDLE *osHdl, OSS_ALARM_HANDLE **alarmP)
+{
+	OSS_ALARM_HANDLE *alm = *alarmP;
+
+	pthread_mutex_lock(&alm->mtx);
+	alm->quit = 1;
+	pthread_cond_signal(&alm->cond);
+	pthread_mutex_unlock(&alm->mtx);
+
+	pthread_join(alm->thread, NULL);
+	pthread_mutex_destroy(&alm->mtx);
+	pthread_cond_destroy(&alm->cond);
+	free(alm);
+	*alarmP = NULL;
+
+	return(ERR_SUCCESS);
+}
+
+int32 OSS_AlarmSet(OSS_HANDLE *osHdl, OSS_ALARM_HANDLE *alm, u_int32 msec,
+				   u_int32 cyclic, u_int32 *realMsecP)
+{
+	if (G_alarmFail) {
+		G_alarmFail--;
+		return(ERR_OSS_BUSY_RESOURCE);
+	}
+
+	if (msec == 0)
+		msec = 1;
+
+	pthread_mutex_lock(&alm->mtx);
+	clock_gettime(CLOCK_MONOTONIC, &alm->due);
+	TsAddNs(&alm->due, (u_int64)msec * 1000000);
+	alm->cyclicNs = cyclic ? msec * 1000000 : 0;
+	alm->armed    = 1;
+	pthread_cond_signal(&alm->cond);
+	pthread_mutex_unlock(&alm->mtx);
+
+	*realMsecP = msec;
+	return(ERR_SUCCESS);
+}
+
+int32 OSS_AlarmClear(OSS_HANDLE *osHdl, OSS_ALARM_HANDLE *alm)
+{
+	int32 error;
+
+	pthread_mutex_lock(&alm->mtx);
+	error = alm->armed ? ERR_SUCCESS : ERR_OSS_ALARM_CLR;
+	alm->armed = 0;
+	pthread_cond_signal(&alm->cond);
+	pthread_mutex_unlock(&alm->mtx);
+
+	return(error);
+}
+
+/******************************* AlarmThread ********************************
+ *
+ *  Description: Alarm thread: wait for expiry, call alarm routine
+ *
+ *               The alarm routine is called without the alarm mutex held,
+ *               so it may re-arm its own alarm.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: arg	alarm handle
+ *  Output.....: return NULL
+ *  Globals....: -
+ ****************************************************************************/
+static void *AlarmThread(void *arg)
+{
+	OSS_ALARM_HANDLE *alm = (OSS_ALARM_HANDLE*)arg;
+
+	pthread_mutex_lock(&alm->mtx);
+
+	while (!alm->quit) {
+		if (!alm->armed) {
+			pthread_cond_wait(&alm->cond, &alm->mtx);
+			continue;
+		}
+
+		if (pthread_cond_timedwait(&alm->cond, &alm->mtx, &alm->due)
+			!= ETIMEDOUT)
+			continue;	/* re-armed, cleared or removed */
+
+		if (alm->cyclicNs)
+			TsAddNs(&alm->due, alm->cyclicNs);
+		else
+			alm->armed = 0;
+
+		pthread_mutex_unlock(&alm->mtx);
+		alm->funct(alm->arg);
+		pthread_mutex_lock(&alm->mtx);
+	}
+
+	pthread_mutex_unlock(&alm->mtx);
+	return(NULL);
+}
+
+/*****************************************************************************
+ *                         H E L P E R S
+ ****************************************************************************/
+
+static void TsAddNs(struct timespec *ts, u_int64 ns)
+{
+	ns += ts->tv_nsec;
+	ts->tv_sec  += ns / 1000000000;
+	ts->tv_nsec  = ns % 1000000000;
+}
+
+/********************************* NsDelay **********************************
+ *
+ *  Description: Busy-wait (latency injection, micro delay)
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: ns		delay [ns]
+ *  Output.....: -
+ *  Globals....: -
+ ****************************************************************************/
+static void NsDelay(u_int32 ns)
+{
+	struct timespec now, due;
+
+	if (ns == 0)
+		return;
+
+	clock_gettime(CLOCK_MONOTONIC, &due);
+	TsAddNs(&due, ns);
+
+	do {
+		clock_gettime(CLOCK_MONOTONIC, &now);
+	} while ((now.tv_sec < due.tv_sec) ||
+			 (now.tv_sec == due.tv_sec && now.tv_nsec < due.tv_nsec));
+}
@@ -0,0 +1,76 @@
+/***********************  I n c l u d e  -  F i l e  ************************
+ *
+ *         Name: m27_sim.h
+ *
+ *  Description: M27 host simulation interface
+ *               - register model and ID PROM of a simulated M-Module
+ *               - simulated MDIS devices for the M_xxx user interface
+ *
+ *---------------------------------------------------------------------------
+ * Copyright 2026, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _M27_SIM_H
+#define _M27_SIM_H
+
+#ifdef __cplusplus
+	extern "C" {
+#endif
+
+/*-----------------------------------------+
+|  DEFINES                                 |
++-----------------------------------------*/
+#define M27SIM_REG_SIZE		256		/* size of address space [bytes] */
+#define M27SIM_PROM_SIZE	128		/* size of ID PROM [bytes] */
+#define M27SIM_DESC_MAX		16		/* max. nr of descriptor keys */
+
+/*-----------------------------------------+
+|  TYPEDEFS                                |
++-----------------------------------------*/
+/* simulated M-Module */
+typedef struct M27SIM_HW {
+	u_int16	reg[M27SIM_REG_SIZE/2];		/* registers */
+	u_int16	prom[M27SIM_PROM_SIZE/2];	/* ID PROM words */
+	u_int32	rdLatNs;					/* register read latency [ns] */
+	u_int32	wrLatNs;					/* register write latency [ns] */
+	u_int32	promLatNs;					/* ID PROM word read latency [ns] */
+	u_int32	rdCount;					/* register reads */
+	u_int32	wrCount;					/* register writes */
+	u_int32	promCount;					/* ID PROM word reads */
+} M27SIM_HW;
+
+/*-----------------------------------------+
+|  PROTOTYPES                              |
++-----------------------------------------*/
+/* register model */
+extern void M27SIM_HwInit(M27SIM_HW *hw, u_int16 modId);
+extern void M27SIM_LatencySet(M27SIM_HW *hw, u_int32 rdNs, u_int32 wrNs,
+							  u_int32 promNs);
+extern void M27SIM_LatencyFromEnv(M27SIM_HW *hw);
+
+/* os services */
+extern void M27SIM_AlarmFail(u_int32 count);
+
+/* simulated MDIS devices (M_open etc.) */
+extern int32 M27SIM_DescSet(const char *key, u_int32 value);
+extern M27SIM_HW *M27SIM_DevHw(const char *device);
+
+#ifdef __cplusplus
+	}
+#endif
+
+#endif /* _M27_SIM_H */
@@ -0,0 +1,669 @@
+/*********************  P r o g r a m  -  M o d u l e ***********************
+ *
+ *         Name: m27_simapi.c
+ *      Project: M27 host simulation
+ *
+ *  Description: Simulated MDIS user interface (M_xxx), UOS and UTL
+ *               functions for running M27 tools on a plain Linux host
+ *
+ *               Every device name opened with M_open() gets its own
+ *               simulated M-Module and M27 driver instance. The driver is
+ *               initialized on the first open and de-initialized on the
+ *               last close, like the MDIS kernel does.
+ *
+ *               Descriptor keys for the next device initialization are
+ *               taken from M27SIM_DescSet() or from the environment
+ *               variable M27SIM_DESC ("KEY=value,KEY=value").
+ *               M27SIM_MODID overrides the module id in the ID PROM,
+ *               M27SIM_LAT sets the register latencies (see m27_sim.c).
+ *
+ *               The process lock mode reported by the driver
+ *               (LL_INFO_LOCKMODE) is honoured: LL_LOCK_CALL serializes
+ *               all calls with the device semaphore, LL_LOCK_CHAN with
+ *               one semaphore per channel.
+ *
+ *     Required: libpthread
+ *     Switches: -
+ *
+ *---------------------------------------------------------------------------
+ * Copyright 2026, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <MEN/men_typs.h>
+#include <MEN/maccess.h>
+#include <MEN/oss.h>
+#include <MEN/desc.h>
+#include <MEN/mdis_api.h>
+#include <MEN/mdis_err.h>
+#include <MEN/ll_defs.h>
+#include <MEN/ll_entry.h>
+#include <MEN/usr_oss.h>
+#include <MEN/usr_utl.h>
+#include "m27_sim.h"
+
+extern void M27_GetEntry(LL_ENTRY *drvP);
+
+/*-----------------------------------------+
+|  DEFINES                                 |
++-----------------------------------------*/
+#define DEV_MAX			8			/* max. nr of simulated devices */
+#define PATH_MAX_NBR	64			/* max. nr of open paths */
+#define CH_MAX			16			/* max. nr of channels */
+#define NAME_LEN		32			/* max. device name length */
+
+/*-----------------------------------------+
+|  TYPEDEFS                                |
++-----------------------------------------*/
+typedef struct {
+	char			name[NAME_LEN];	/* device name */
+	int32			openCnt;		/* nr of open paths */
+	M27SIM_HW		hw;				/* simulated module */
+	MACCESS			ma;				/* access handle (points to hw) */
+	LL_ENTRY		entry;			/* driver jump table */
+	LL_HANDLE		*llHdl;			/* driver handle */
+	u_int32			lockMode;		/* LL_LOCK_xxx */
+	int32			chNbr;			/* nr of channels */
+	OSS_SEM_HANDLE	*devSem;		/* device semaphore */
+	OSS_SEM_HANDLE	*chSem[CH_MAX];	/* channel semaphores */
+	DESC_SPEC		desc[M27SIM_DESC_MAX+1];	/* descriptor */
+} SIM_DEV;
+
+typedef struct {
+	SIM_DEV			*dev;			/* device (NULL=unused) */
+	int32			ch;				/* current channel */
+} SIM_PATH;
+
+/*-----------------------------------------+
+|  GLOBALS                                 |
++-----------------------------------------*/
+static pthread_mutex_t G_lock = PTHREAD_MUTEX_INITIALIZER;
+static SIM_DEV   G_dev[DEV_MAX];
+static SIM_PATH  G_path[PATH_MAX_NBR];
+static DESC_SPEC G_desc[M27SIM_DESC_MAX+1];
+static int       G_descNbr;
+static __thread u_int32 G_errno;
+
+/*-----------------------------------------+
+|  PROTOTYPES                              |
++-----------------------------------------*/
+static SIM_PATH *PathGet(MDIS_PATH path);
+static OSS_SEM_HANDLE *LockGet(SIM_PATH *p);
+static void DescFromEnv(void);
+static int32 Fail(int32 error);
+
+/****************************** M27SIM_DescSet ******************************
+ *
+ *  Description: Set descriptor key for following device initializations
+ *
+ *               A key that is already set is overwritten.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: key	descriptor key (e.g. "PWM_TICK")
+ *               value  value
+ *  Output.....: return 0 | -1 (too many keys)
+ *  Globals....: G_desc, G_descNbr
+ ****************************************************************************/
+int32 M27SIM_DescSet(const char *key, u_int32 value)
+{
+	int n;
+
+	for (n=0; n<G_descNbr; n++) {
+		if (strcmp(G_desc[n].key, key) == 0) {
+			G_desc[n].value = value;
+			return(0);
+		}
+	}
+
+	if (G_descNbr == M27SIM_DESC_MAX)
+		return(-1);
+
+	G_desc[G_descNbr].key   = strdup(key);
+	G_desc[G_descNbr].value = value;
+	G_descNbr++;
+
+	return(0);
+}
+
+/******************************* M27SIM_DevHw *******************************
+ *
+ *  Description: Get simulated module of an open device
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: device	device name
+ *  Output.....: return module | NULL (device not open)
+ *  Globals....: G_dev
+ ****************************************************************************/
+M27SIM_HW *M27SIM_DevHw(const char *device)
+{
+	int n;
+
+	for (n=0; n<DEV_MAX; n++)
+		if (G_dev[n].openCnt && strcmp(G_dev[n].name, device) == 0)
+			return(&G_dev[n].hw);
+
+	return(NULL);
+}
+
+/********************************* M_open ***********************************
+ *
+ *  Description: Open path to simulated device
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: device	device name
+ *  Output.....: return path | -1 (error)
+ *  Globals....: G_dev, G_path
+ ****************************************************************************/
+MDIS_PATH M_open(const char *device)
+{
+	SIM_DEV *dev = NULL;
+	char *env;
+	int32 error = ERR_SUCCESS;
+	int n, path;
+
+	pthread_mutex_lock(&G_lock);
+
+	for (path=0; path<PATH_MAX_NBR && G_path[path].dev; path++)
+		;
+	if (path == PATH_MAX_NBR) {
+		error = ERR_MK_NO_PATH;
+		goto EXIT;
+	}
+
+	/* device already open ? */
+	for (n=0; n<DEV_MAX && !dev; n++)
+		if (G_dev[n].openCnt && strcmp(G_dev[n].name, device) == 0)
+			dev = &G_dev[n];
+
+	/* first open: init device */
+	if (dev == NULL) {
+		for (n=0; n<DEV_MAX && G_dev[n].openCnt; n++)
+			;
+		if (n == DEV_MAX || strlen(device) >= NAME_LEN) {
+			error = ERR_MK_NO_LLDRV;
+			goto EXIT;
+		}
+		dev = &G_dev[n];
+		memset(dev, 0, sizeof(*dev));
+		strcpy(dev->name, device);
+
+		env = getenv("M27SIM_MODID");
+		M27SIM_HwInit(&dev->hw, (u_int16)(env ? atoi(env) : 27));
+		M27SIM_LatencyFromEnv(&dev->hw);
+		dev->ma = &dev->hw;
+
+		DescFromEnv();
+		memcpy(dev->desc, G_desc, sizeof(dev->desc));
+
+		M27_GetEntry(&dev->entry);
+		dev->entry.info(LL_INFO_LOCKMODE, &dev->lockMode);
+
+		OSS_SemCreate(NULL, OSS_SEM_BIN, 1, &dev->devSem);
+
+		if ((error = dev->entry.init(dev->desc, NULL, &dev->ma, dev->devSem,
+									 NULL, &dev->llHdl))) {
+			OSS_SemRemove(NULL, &dev->devSem);
+			goto EXIT;
+		}
+
+		dev->chNbr = 1;
+		dev->entry.getStat(dev->llHdl, M_LL_CH_NUMBER, 0,
+						   (INT32_OR_64*)&dev->chNbr);
+		if (dev->chNbr > CH_MAX)
+			dev->chNbr = CH_MAX;
+
+		for (n=0; n<dev->chNbr; n++)
+			OSS_SemCreate(NULL, OSS_SEM_BIN, 1, &dev->chSem[n]);
+	}
+
+	dev->openCnt++;
+	G_path[path].dev = dev;
+	G_path[path].ch  = 0;
+
+ EXIT:
+	pthread_mutex_unlock(&G_lock);
+
+	if (error)
+		return(Fail(error));
+
+	return(path + 1);
+}
+
+/********************************* M_close **********************************
+ *
+ *  Description: Close path, de-init device on last close
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: path	path
+ *  Output.....: return 0 | -1 (error)
+ *  Globals....: G_dev, G_path
+ ****************************************************************************/
+int32 M_close(MDIS_PATH path)
+{
+	SIM_PATH *p;
+	SIM_DEV *dev;
+	int32 error = ERR_SUCCESS;
+	int n;
+
+	if ((p = PathGet(path)) == NULL)
+		return(Fail(ERR_MK_ILL_PATH));
+
+	pthread_mutex_lock(&G_lock);
+
+	dev = p->dev;
+	p->dev = NULL;
+
+	if (--dev->openCnt == 0) {
+		error = dev->entry.exit(&dev->llHdl);
+
+		for (n=0; n<dev->chNbr; n++)
+			OSS_SemRemove(NULL, &dev->chSem[n]);
+		OSS_SemRemove(NULL, &dev->devSem);
+	}
+
+	pthread_mutex_unlock(&G_lock);
+
+	return(error ? Fail(error) : 0);
+}
+
+/********************************** M_read **********************************
+ *
+ *  Description: Read from current channel
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: path	path
+ *  Output.....: return 0 | -1 (error)
+ *               *valueP read value
+ *  Globals....: -
+ ****************************************************************************/
+int32 M_read(MDIS_PATH path, int32 *valueP)
+{
+	SIM_PATH *p;
+	OSS_SEM_HANDLE *sem;
+	int32 error;
+
+	if ((p = PathGet(path)) == NULL)
+		return(Fail(ERR_MK_ILL_PATH));
+
+	if ((sem = LockGet(p)))
+		OSS_SemWait(NULL, sem, OSS_SEM_WAITFOREVER);
+	error = p->dev->entry.read(p->dev->llHdl, p->ch, valueP);
+	if (sem)
+		OSS_SemSignal(NULL, sem);
+
+	return(error ? Fail(error) : 0);
+}
+
+/********************************* M_write **********************************
+ *
+ *  Description: Write to current channel
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: path	path
+ *               value  value to write
+ *  Output.....: return 0 | -1 (error)
+ *  Globals....: -
+ ****************************************************************************/
+int32 M_write(MDIS_PATH path, int32 value)
+{
+	SIM_PATH *p;
+	OSS_SEM_HANDLE *sem;
+	int32 error;
+
+	if ((p = PathGet(path)) == NULL)
+		return(Fail(ERR_MK_ILL_PATH));
+
+	if ((sem = LockGet(p)))
+		OSS_SemWait(NULL, sem, OSS_SEM_WAITFOREVER);
+	error = p->dev->entry.write(p->dev->llHdl, p->ch, value);
+	if (sem)
+		OSS_SemSignal(NULL, sem);
+
+	return(error ? Fail(error) : 0);
+}
+
+/******************************** M_getstat *********************************
+ *
+ *  Description: Get status (standard or block code)
+ *
+ *               For block codes dataP points to an M_SG_BLOCK.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: path	path
+ *               code   status code
+ *  Output.....: return 0 | -1 (error)
+ *               *dataP status value
+ *  Globals....: -
+ ****************************************************************************/
+int32 M_getstat(MDIS_PATH path, int32 code, int32 *dataP)
+{
+	SIM_PATH *p;
+	OSS_SEM_HANDLE *sem;
+	INT32_OR_64 val = 0;
+	int32 error;
+
+	if ((p = PathGet(path)) == NULL)
+		return(Fail(ERR_MK_ILL_PATH));
+
+	if (code == M_MK_CH_CURRENT) {
+		*dataP = p->ch;
+		return(0);
+	}
+
+	if ((sem = LockGet(p)))
+		OSS_SemWait(NULL, sem, OSS_SEM_WAITFOREVER);
+
+	if (M_BLK_CODE(code))
+		error = p->dev->entry.getStat(p->dev->llHdl, code, p->ch,
+									  (INT32_OR_64*)dataP);
+	else if ((error = p->dev->entry.getStat(p->dev->llHdl, code, p->ch,
+											&val)) == ERR_SUCCESS)
+		*dataP = (int32)val;
+
+	if (sem)
+		OSS_SemSignal(NULL, sem);
+
+	return(error ? Fail(error) : 0);
+}
+
+/******************************** M_setstat *********************************
+ *
+ *  Description: Set status (standard or block code)
+ *
+ *               For block codes data is a pointer to an M_SG_BLOCK.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: path	path
+ *               code   status code
+ *               data   status value
+ *  Output.....: return 0 | -1 (error)
+ *  Globals....: -
+ ****************************************************************************/
+int32 M_setstat(MDIS_PATH path, int32 code, INT32_OR_64 data)
+{
+	SIM_PATH *p;
+	OSS_SEM_HANDLE *sem;
+	int32 error;
+
+	if ((p = PathGet(path)) == NULL)
+		return(Fail(ERR_MK_ILL_PATH));
+
+	if (code == M_MK_CH_CURRENT) {
+		if (data < 0 || data >= p->dev->chNbr)
+			return(Fail(ERR_MK_ILL_PARAM));
+		p->ch = (int32)data;
+		return(0);
+	}
+
+	if ((sem = LockGet(p)))
+		OSS_SemWait(NULL, sem, OSS_SEM_WAITFOREVER);
+	error = p->dev->entry.setStat(p->dev->llHdl, code, p->ch, data);
+	if (sem)
+		OSS_SemSignal(NULL, sem);
+
+	return(error ? Fail(error) : 0);
+}
+
+/******************************** M_getblock ********************************
+ *
+ *  Description: Block read
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: path	path
+ *               buffer buffer
+ *               length buffer size [bytes]
+ *  Output.....: return nr of bytes read | -1 (error)
+ *  Globals....: -
+ ****************************************************************************/
+int32 M_getblock(MDIS_PATH path, u_int8 *buffer, int32 length)
+{
+	SIM_PATH *p;
+	OSS_SEM_HANDLE *sem;
+	int32 error, nbr = 0;
+
+	if ((p = PathGet(path)) == NULL)
+		return(Fail(ERR_MK_ILL_PATH));
+
+	if ((sem = LockGet(p)))
+		OSS_SemWait(NULL, sem, OSS_SEM_WAITFOREVER);
+	error = p->dev->entry.blockRead(p->dev->llHdl, p->ch, buffer, length,
+									&nbr);
+	if (sem)
+		OSS_SemSignal(NULL, sem);
+
+	return(error ? Fail(error) : nbr);
+}
+
+/******************************** M_setblock ********************************
+ *
+ *  Description: Block write
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: path	path
+ *               buffer buffer
+ *               length buffer size [bytes]
+ *  Output.....: return nr of bytes written | -1 (error)
+ *  Globals....: -
+ ****************************************************************************/
+int32 M_setblock(MDIS_PATH path, const u_int8 *buffer, int32 length)
+{
+	SIM_PATH *p;
+	OSS_SEM_HANDLE *sem;
+	int32 error, nbr = 0;
+
+	if ((p = PathGet(path)) == NULL)
+		return(Fail(ERR_MK_ILL_PATH));
+
+	if ((sem = LockGet(p)))
+		OSS_SemWait(NULL, sem, OSS_SEM_WAITFOREVER);
+	error = p->dev->entry.blockWrite(p->dev->llHdl, p->ch, (void*)buffer,
+									 length, &nbr);
+	if (sem)
+		OSS_SemSignal(NULL, sem);
+
+	return(error ? Fail(error) : nbr);
+}
+
+/******************************* M_errstring ********************************
+ *
+ *  Description: Get error message
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: errCode	error code
+ *  Output.....: return message (static buffer)
+ *  Globals....: -
+ ****************************************************************************/
+char *M_errstring(int32 errCode)
+{
+	static __thread char buf[64];
+
+	snprintf(buf, sizeof(buf), "ERROR (SIM) 0x%04x: %s", (unsigned)errCode,
+			 errCode >= ERR_DEV ? "device specific error" :
+			 errCode >= ERR_LL  ? "low-level driver error" :
+			 errCode >= ERR_MK  ? "MDIS kernel error" : "OS error");
+	return(buf);
+}
+
+/*****************************************************************************
+ *                         U O S   /   U T L
+ ****************************************************************************/
+
+u_int32 UOS_ErrnoGet(void)
+{
+	return(G_errno);
+}
+
+u_int32 UOS_ErrnoSet(u_int32 errCode)
+{
+	return(G_errno = errCode);
+}
+
+int32 UOS_Delay(u_int32 msec)
+{
+	usleep(msec * 1000);
+	return(msec);
+}
+
+u_int32 UOS_MsecTimerGet(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return((u_int32)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000));
+}
+
+int32 UOS_KeyPressed(void)
+{
+	struct pollfd pfd = { 0, POLLIN, 0 };
+	char c;
+
+	if (poll(&pfd, 1, 0) == 1 && read(0, &c, 1) == 1)
+		return(c);
+
+	return(-1);
+}
+
+int32 UOS_KeyWait(void)
+{
+	char c;
+
+	return(read(0, &c, 1) == 1 ? c : -1);
+}
+
+/******************************** UTL_Tstopt ********************************
+ *
+ *  Description: Test for option "-<c>" or "-<c>=<value>"
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: argc,argv	arguments
+ *               option     option char, followed by '=' for value options
+ *  Output.....: return value string | "" (flag set) | NULL (not found)
+ *  Globals....: -
+ ****************************************************************************/
+char *UTL_Tstopt(int argc, char **argv, char *option)
+{
+	int n;
+
+	for (n=1; n<argc; n++) {
+		if (argv[n][0] != '-' || argv[n][1] != option[0])
+			continue;
+
+		if (option[1] == '=')
+			return(argv[n][2] == '=' ? &argv[n][3] : &argv[n][2]);
+
+		return(&argv[n][2]);
+	}
+
+	return(NULL);
+}
+
+/******************************** UTL_Illiopt *******************************
+ *
+ *  Description: Check for illegal options
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: argc,argv	arguments
+ *               opts       valid option chars ('=' after value options)
+ *               errstr     buffer for error message
+ *  Output.....: return NULL (ok) | errstr
+ *  Globals....: -
+ ****************************************************************************/
+char *UTL_Illiopt(int argc, char **argv, char *opts, char *errstr)
+{
+	int n;
+
+	for (n=1; n<argc; n++) {
+		if (argv[n][0] != '-' || argv[n][1] == '\0')
+			continue;
+
+		if (argv[n][1] == '=' || strchr(opts, argv[n][1]) == NULL) {
+			sprintf(errstr, "*** illegal option: %s\n", argv[n]);
+			return(errstr);
+		}
+	}
+
+	return(NULL);
+}
+
+/*****************************************************************************
+ *                         H E L P E R S
+ ****************************************************************************/
+
+static SIM_PATH *PathGet(MDIS_PATH path)
+{
+	if (path < 1 || path > PATH_MAX_NBR || G_path[path-1].dev == NULL)
+		return(NULL);
+
+	return(&G_path[path-1]);
+}
+
+/********************************* LockGet **********************************
+ *
+ *  Description: Get semaphore required by the driver's process lock mode
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: p		path
+ *  Output.....: return semaphore | NULL (LL_LOCK_NONE)
+ *  Globals....: -
+ ****************************************************************************/
+static OSS_SEM_HANDLE *LockGet(SIM_PATH *p)
+{
+	switch (p->dev->lockMode) {
+		case LL_LOCK_CALL:	return(p->dev->devSem);
+		case LL_LOCK_CHAN:	return(p->dev->chSem[p->ch]);
+		default:			return(NULL);
+	}
+}
+
+/******************************* DescFromEnv ********************************
+ *
+ *  Description: Add descriptor keys from M27SIM_DESC
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: -
+ *  Output.....: -
+ *  Globals....: G_desc
+ ****************************************************************************/
+static void DescFromEnv(void)
+{
+	char *env = getenv("M27SIM_DESC");
+	char *buf, *tok, *eq, *save = NULL;
+
+	if (env == NULL || (buf = strdup(env)) == NULL)
+		return;
+
+	for (tok=strtok_r(buf, ",", &save); tok; tok=strtok_r(NULL, ",", &save))
+		if ((eq = strchr(tok, '='))) {
+			*eq = '\0';
+			M27SIM_DescSet(tok, (u_int32)strtoul(eq+1, NULL, 0));
+		}
+
+	free(buf);
+}
+
+static int32 Fail(int32 error)
+{
+	G_errno = error;
+	return(-1);
+}
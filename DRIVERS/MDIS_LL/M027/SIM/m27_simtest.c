@@ -0,0 +1,1040 @@
+/*********************  P r o g r a m  -  M o d u l e ***********************
+ *
+ *         Name: m27_simtest.c
+ *      Project: M27 host simulation
+ *
+ *  Description: Functional test of the M27 driver on the simulated
+ *               M-Module
+ *
+ *               Calls the driver's LL_ENTRY functions directly, then runs
+ *               the driver through the simulated M_xxx interface, and
+ *               checks the resulting register contents and access counts.
+ *               Exits with 0 if all checks passed.
+ *
+ *     Required: libm27sim.a, m27_grp.c
+ *     Switches: -
+ *
+ *---------------------------------------------------------------------------
+ * Copyright 2026, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <MEN/men_typs.h>
+#include <MEN/mdis_api.h>
+#include <MEN/mdis_err.h>
+#include <MEN/usr_oss.h>
+#include <MEN/maccess.h>
+#include <MEN/oss.h>
+#include <MEN/desc.h>
+#include <MEN/ll_defs.h>
+#include <MEN/ll_entry.h>
+#include <MEN/m27_drv.h>
+#include <MEN/m27_grp.h>
+#include "m27_sim.h"
+
+/*-----------------------------------------+
+|  DEFINES                                 |
++-----------------------------------------*/
+#define DEVICE		"m27_sim"
+
+/* check condition, count failures */
+#define CHECK(cond) \
+	do { \
+		G_checks++; \
+		if (!(cond)) { \
+			G_fails++; \
+			printf("*** %s:%d: check failed: %s\n", \
+				   __FILE__, __LINE__, #cond); \
+		} \
+	} while (0)
+
+/* MDIS call must succeed */
+#define CALL(expr) \
+	do { \
+		G_checks++; \
+		if ((expr) < 0) { \
+			G_fails++; \
+			printf("*** %s:%d: %s: %s\n", __FILE__, __LINE__, #expr, \
+				   M_errstring(UOS_ErrnoGet())); \
+		} \
+	} while (0)
+
+/*-----------------------------------------+
+|  GLOBALS                                 |
++-----------------------------------------*/
+static int G_checks;
+static int G_fails;
+
+/*-----------------------------------------+
+|  PROTOTYPES                              |
++-----------------------------------------*/
+extern void M27_GetEntry(LL_ENTRY *drvP);
+
+static void TestLlEntry(void);
+static void TestWrite(MDIS_PATH path, M27SIM_HW *hw);
+static void TestMask(MDIS_PATH path, M27SIM_HW *hw);
+static void TestBlock(MDIS_PATH path, M27SIM_HW *hw);
+static void TestSeq(MDIS_PATH path, M27SIM_HW *hw);
+static void TestPulse(MDIS_PATH path, M27SIM_HW *hw);
+static void TestPwm(MDIS_PATH path, M27SIM_HW *hw);
+static void TestStats(MDIS_PATH path, M27SIM_HW *hw);
+static void TestTrace(MDIS_PATH path, M27SIM_HW *hw);
+static void TestStaging(MDIS_PATH path, M27SIM_HW *hw);
+static void TestCmdList(MDIS_PATH path, M27SIM_HW *hw);
+static void TestWaitChange(MDIS_PATH path, M27SIM_HW *hw);
+static void *WaitThread(void *arg);
+static void TestGroup(MDIS_PATH path, M27SIM_HW *hw);
+static void TestIdCheck(void);
+static void TestWarmRestart(void);
+static void TestLockMode(u_int32 lockMode);
+static void *WriterThread(void *arg);
+
+/********************************* main *************************************
+ *
+ *  Description: Program main function
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: -
+ *  Output.....: return 0 (all checks passed) | 1
+ *  Globals....: -
+ ****************************************************************************/
+int main(void)
+{
+	MDIS_PATH path;
+	M27SIM_HW *hw;
+
+	TestLlEntry();
+
+	if ((path = M_open(DEVICE)) < 0) {
+		printf("*** can't open %s: %s\n", DEVICE,
+			   M_errstring(UOS_ErrnoGet()));
+		return(1);
+	}
+	hw = M27SIM_DevHw(DEVICE);
+
+	TestWrite(path, hw);
+	TestMask(path, hw);
+	TestBlock(path, hw);
+	TestSeq(path, hw);
+	TestPulse(path, hw);
+	TestPwm(path, hw);
+	TestStats(path, hw);
+	TestTrace(path, hw);
+	TestStaging(path, hw);
+	TestCmdList(path, hw);
+	TestWaitChange(path, hw);
+	TestGroup(path, hw);
+
+	CALL(M_close(path));
+	CHECK(M27SIM_DevHw(DEVICE) == NULL);
+
+	TestIdCheck();
+	TestWarmRestart();
+	TestLockMode(M27_LOCKMODE_FAST);
+	TestLockMode(M27_LOCKMODE_CHAN);
+
+	printf("%d checks, %d failed\n", G_checks, G_fails);
+	return(G_fails ? 1 : 0);
+}
+
+/******************************* TestLlEntry ********************************
+ *
+ *  Description: Init, i/o, getstat and exit via the LL_ENTRY jump table
+ *
+ ****************************************************************************/
+static void TestLlEntry(void)
+{
+	static DESC_SPEC desc[] = { { "ID_CHECK", 1 }, { NULL, 0 } };
+	LL_ENTRY entry;
+	LL_HANDLE *llHdl = NULL;
+	M27SIM_HW hw;
+	MACCESS ma = &hw;
+	INT32_OR_64 val = 0;
+	u_int16 id[M27SIM_PROM_SIZE/2];
+	M27_INIT_TIME it;
+	M_SG_BLOCK blk;
+	u_int32 lockMode = 0xffffffff;
+	int32 v;
+
+	M27SIM_HwInit(&hw, 81);
+	hw.reg[0] = 0xffff;
+	M27_GetEntry(&entry);
+
+	CHECK(entry.info(LL_INFO_LOCKMODE, &lockMode) == ERR_SUCCESS);
+	CHECK(lockMode == LL_LOCK_NONE);	/* driver locks itself */
+
+	CHECK(entry.init(desc, NULL, &ma, NULL, NULL, &llHdl) == ERR_SUCCESS);
+	CHECK(hw.reg[0] == 0x0000);			/* outputs reset */
+	CHECK(hw.promCount == 64);			/* whole prom read at init */
+
+	CHECK(entry.getStat(llHdl, M_LL_CH_NUMBER, 0, &val) == ERR_SUCCESS);
+	CHECK(val == 16);
+
+	CHECK(entry.write(llHdl, 15, 1) == ERR_SUCCESS);
+	CHECK(hw.reg[0] == 0x8000);
+	CHECK(entry.read(llHdl, 15, &v) == ERR_SUCCESS);
+	CHECK(v == 1);
+	CHECK(entry.setStat(llHdl, M27_SET_MASK, 0, 0x0003) == ERR_SUCCESS);
+	CHECK(hw.reg[0] == 0x8003);
+
+	blk.size = sizeof(id);
+	blk.data = id;
+	CHECK(entry.getStat(llHdl, M_LL_BLK_ID_DATA, 0,
+						(INT32_OR_64*)&blk) == ERR_SUCCESS);
+	CHECK(id[0] == 0x5346 && id[1] == 81);
+	CHECK(id[3] == 0x3333 && id[63] == hw.prom[63]);
+	CHECK(hw.promCount == 64);			/* no prom access */
+	memset(id, 0, sizeof(id));
+	CHECK(entry.getStat(llHdl, M_LL_BLK_ID_DATA, 0,
+						(INT32_OR_64*)&blk) == ERR_SUCCESS);
+	CHECK(id[0] == 0x5346 && id[63] == hw.prom[63]);
+	CHECK(hw.promCount == 64);
+	blk.size = sizeof(id) - 2;
+	CHECK(entry.getStat(llHdl, M_LL_BLK_ID_DATA, 0,
+						(INT32_OR_64*)&blk) == ERR_LL_USERBUF);
+
+	blk.size = sizeof(it);
+	blk.data = &it;
+	CHECK(entry.getStat(llHdl, M27_BLK_INIT_TIME, 0,
+						(INT32_OR_64*)&blk) == ERR_SUCCESS);
+	CHECK(blk.size == sizeof(it) && it.unitNs > 0);
+	CHECK(it.total >= it.desc + it.idCheck + it.reset);
+
+	CHECK(entry.exit(&llHdl) == ERR_SUCCESS);
+	CHECK(hw.reg[0] == 0x0000);			/* outputs reset */
+
+	/* LOCK_MODE */
+	desc[0].key = "LOCK_MODE";
+	desc[0].value = M27_LOCKMODE_FAST;
+	CHECK(entry.init(desc, NULL, &ma, NULL, NULL, &llHdl) == ERR_SUCCESS);
+	CHECK(entry.getStat(llHdl, M27_LOCK_MODE, 0, &val) == ERR_SUCCESS);
+	CHECK(val == M27_LOCKMODE_FAST);
+	CHECK(entry.write(llHdl, 1, 1) == ERR_SUCCESS);
+	CHECK(hw.reg[0] == 0x0002);
+	CHECK(entry.exit(&llHdl) == ERR_SUCCESS);
+
+	desc[0].value = M27_LOCKMODE_CHAN;
+	CHECK(entry.init(desc, NULL, &ma, NULL, NULL, &llHdl) == ERR_SUCCESS);
+	CHECK(entry.write(llHdl, 15, 1) == ERR_SUCCESS);
+	CHECK(entry.read(llHdl, 15, &v) == ERR_SUCCESS);
+	CHECK(v == 1);
+	CHECK(hw.reg[0] == 0x8000);
+	CHECK(entry.exit(&llHdl) == ERR_SUCCESS);
+
+	desc[0].value = 99;
+	CHECK(entry.init(desc, NULL, &ma, NULL, NULL, &llHdl) == ERR_LL_ILL_PARAM);
+}
+
+/******************************** TestWrite *********************************
+ *
+ *  Description: Single channel read/write, redundant write suppression
+ *
+ ****************************************************************************/
+static void TestWrite(MDIS_PATH path, M27SIM_HW *hw)
+{
+	int32 val, n;
+	u_int32 wr;
+
+	CHECK(hw->reg[0] == 0x0000);
+
+	CALL(M_setstat(path, M_MK_CH_CURRENT, 3));
+	CALL(M_write(path, 1));
+	CHECK(hw->reg[0] == 0x0008);
+
+	/* same value again: no register access */
+	wr = hw->wrCount;
+	CALL(M_write(path, 1));
+	CHECK(hw->wrCount == wr);
+
+	CALL(M_read(path, &val));
+	CHECK(val == 1);
+
+	/* read back from hardware */
+	hw->reg[0] = 0x0000;
+	CALL(M_read(path, &val));
+	CHECK(val == 1);				/* shadow */
+	CALL(M_setstat(path, M27_READBACK, 1));
+	CALL(M_read(path, &val));
+	CHECK(val == 0);				/* hardware */
+	CALL(M_setstat(path, M27_READBACK, 0));
+
+	for (n=0; n<16; n++) {
+		CALL(M_setstat(path, M_MK_CH_CURRENT, n));
+		CALL(M_write(path, 0));
+	}
+	CHECK(hw->reg[0] == 0x0000);
+
+	CALL(M_setstat(path, M_MK_CH_CURRENT, 0));
+}
+
+/********************************* TestMask *********************************
+ *
+ *  Description: Masked updates (one register write each)
+ *
+ ****************************************************************************/
+static void TestMask(MDIS_PATH path, M27SIM_HW *hw)
+{
+	u_int32 wr = hw->wrCount;
+
+	CALL(M_setstat(path, M27_SET_MASK, 0x00ff));
+	CHECK(hw->reg[0] == 0x00ff);
+	CALL(M_setstat(path, M27_CLR_MASK, 0x000f));
+	CHECK(hw->reg[0] == 0x00f0);
+	CALL(M_setstat(path, M27_TOGGLE_MASK, 0xffff));
+	CHECK(hw->reg[0] == 0xff0f);
+	CALL(M_setstat(path, M27_WRITE_MASKED, M27_MASKED(0x0ff0, 0x5a5a)));
+	CHECK(hw->reg[0] == 0xfa5f);
+	CHECK(hw->wrCount == wr + 4);
+
+	CALL(M_setstat(path, M27_CLR_MASK, 0xffff));
+	CHECK(hw->reg[0] == 0x0000);
+}
+
+/******************************** TestBlock *********************************
+ *
+ *  Description: Block i/o in byte and packed mode, start channel
+ *
+ ****************************************************************************/
+static void TestBlock(MDIS_PATH path, M27SIM_HW *hw)
+{
+	u_int8 buf[16];
+	u_int16 word;
+	u_int32 wr;
+	int32 n;
+
+	/* byte mode */
+	for (n=0; n<16; n++)
+		buf[n] = (u_int8)(n & 1);
+	wr = hw->wrCount;
+	CHECK(M_setblock(path, buf, 16) == 16);
+	CHECK(hw->reg[0] == 0xaaaa);
+	CHECK(hw->wrCount == wr + 1);
+
+	memset(buf, 0xff, sizeof(buf));
+	CHECK(M_getblock(path, buf, 16) == 16);
+	CHECK(buf[0] == 0 && buf[1] == 1 && buf[15] == 1);
+
+	/* start at current channel */
+	CALL(M_setstat(path, M27_BLOCK_START, M27_BLOCK_START_CURCH));
+	CALL(M_setstat(path, M_MK_CH_CURRENT, 12));
+	memset(buf, 0, sizeof(buf));
+	CHECK(M_setblock(path, buf, 16) < 0);	/* beyond channel 15 */
+	CHECK(M_setblock(path, buf, 4) == 4);
+	CHECK(hw->reg[0] == 0x0aaa);
+	CALL(M_setstat(path, M_MK_CH_CURRENT, 0));
+	CALL(M_setstat(path, M27_BLOCK_START, M27_BLOCK_START_CH0));
+
+	/* packed mode */
+	CALL(M_setstat(path, M27_BLOCK_MODE, M27_BLOCK_PACKED));
+	word = 0x1234;
+	CHECK(M_setblock(path, (u_int8*)&word, 2) == 2);
+	CHECK(hw->reg[0] == 0x1234);
+	word = 0;
+	CHECK(M_getblock(path, (u_int8*)&word, 2) == 2);
+	CHECK(word == 0x1234);
+	CHECK(M_setblock(path, buf, 1) < 0);	/* only whole words */
+	CHECK(M_setblock(path, buf, 3) < 0);
+	CHECK(M_getblock(path, buf, 1) < 0);
+	CHECK(hw->reg[0] == 0x1234);
+
+	/* unaligned buffer */
+	word = 0x8421;
+	memcpy(&buf[1], &word, sizeof(word));
+	CHECK(M_setblock(path, &buf[1], 2) == 2);
+	CHECK(hw->reg[0] == 0x8421);
+	memset(buf, 0, sizeof(buf));
+	CHECK(M_getblock(path, &buf[3], 2) == 2);
+	memcpy(&word, &buf[3], sizeof(word));
+	CHECK(word == 0x8421);
+	CALL(M_setstat(path, M27_BLOCK_MODE, M27_BLOCK_BYTES));
+
+	CALL(M_setstat(path, M27_CLR_MASK, 0xffff));
+}
+
+/********************************* TestSeq **********************************
+ *
+ *  Description: Output sequence engine
+ *
+ ****************************************************************************/
+static void TestSeq(MDIS_PATH path, M27SIM_HW *hw)
+{
+	M27_SEQ_ENTRY tbl[3];
+	M_SG_BLOCK blk;
+	int32 state = 1, steps = 0, n;
+
+	memset(tbl, 0, sizeof(tbl));
+	tbl[0].delta = 0;	tbl[0].word = 0x0001;
+	tbl[1].delta = 5;	tbl[1].word = 0x0003;
+	tbl[2].delta = 5;	tbl[2].word = 0x0007;
+
+	blk.size = sizeof(tbl);
+	blk.data = tbl;
+	CALL(M_setstat(path, M27_BLK_SEQ_TABLE, (INT32_OR_64)&blk));
+	CALL(M_setstat(path, M27_SEQ_LOOPS, 2));
+	CALL(M_setstat(path, M27_SEQ_START, 0));
+
+	for (n=0; n<100 && state; n++) {
+		UOS_Delay(5);
+		CALL(M_getstat(path, M27_SEQ_STATE, &state));
+	}
+	CHECK(state == 0);
+	CALL(M_getstat(path, M27_SEQ_STEPS, &steps));
+	CHECK(steps == 6);
+	CHECK(hw->reg[0] == 0x0007);
+
+	CALL(M_setstat(path, M27_CLR_MASK, 0xffff));
+}
+
+/******************************** TestPulse *********************************
+ *
+ *  Description: Single pulse (busy-wait) and pulse train (alarm)
+ *
+ ****************************************************************************/
+static void TestPulse(MDIS_PATH path, M27SIM_HW *hw)
+{
+	M27_PULSE pulse;
+	M_SG_BLOCK blk;
+	u_int32 wr;
+	int32 active = 1, n;
+
+	memset(&pulse, 0, sizeof(pulse));
+	pulse.mask  = 0x8001;
+	pulse.width = 100;
+	blk.size = sizeof(pulse);
+	blk.data = &pulse;
+
+	wr = hw->wrCount;
+	CALL(M_setstat(path, M27_BLK_PULSE, (INT32_OR_64)&blk));
+	CHECK(hw->wrCount == wr + 2);
+	CHECK(hw->reg[0] == 0x0000);
+
+	pulse.width  = 2000;
+	pulse.count  = 3;
+	pulse.period = 5000;
+	wr = hw->wrCount;
+	CALL(M_setstat(path, M27_BLK_PULSE, (INT32_OR_64)&blk));
+
+	for (n=0; n<100 && active; n++) {
+		UOS_Delay(5);
+		CALL(M_getstat(path, M27_PULSE_ACTIVE, &active));
+	}
+	CHECK(active == 0);
+	CHECK(hw->wrCount == wr + 6);
+	CHECK(hw->reg[0] == 0x0000);
+
+	/* edge count would overflow */
+	pulse.count = 0x80000000;
+	CHECK(M_setstat(path, M27_BLK_PULSE, (INT32_OR_64)&blk) < 0);
+	CHECK(UOS_ErrnoGet() == ERR_LL_ILL_PARAM);
+	CHECK(hw->reg[0] == 0x0000);
+}
+
+/********************************* TestPwm **********************************
+ *
+ *  Description: Software PWM
+ *
+ ****************************************************************************/
+static void TestPwm(MDIS_PATH path, M27SIM_HW *hw)
+{
+	M27_PWM_STATS stats;
+	M_SG_BLOCK blk;
+	u_int32 wr;
+	int32 value;
+
+	CALL(M_setstat(path, M_MK_CH_CURRENT, 2));
+	CALL(M_setstat(path, M27_PWM_DUTY, 500));
+	CALL(M_setstat(path, M27_PWM_PERIOD, 10));
+
+	wr = hw->wrCount;
+	UOS_Delay(200);
+	CHECK(hw->wrCount > wr + 10);
+
+	blk.size = sizeof(stats);
+	blk.data = &stats;
+	CALL(M_getstat(path, M27_BLK_PWM_STATS, (int32*)&blk));
+	CHECK(stats.tickMs >= 1);
+	CHECK(stats.ticks > 0);
+
+	CALL(M_setstat(path, M27_PWM_PERIOD, 0));
+	CHECK((hw->reg[0] & 0x0004) == 0);
+
+	/* alarm can't be started: settings are left unchanged */
+	M27SIM_AlarmFail(1);
+	CHECK(M_setstat(path, M27_PWM_PERIOD, 20) < 0);
+	CHECK(UOS_ErrnoGet() == ERR_OSS_BUSY_RESOURCE);
+	CALL(M_getstat(path, M27_PWM_PERIOD, &value));
+	CHECK(value == 0);
+	CALL(M_getstat(path, M27_PWM_DUTY, &value));
+	CHECK(value == 500);
+
+	CALL(M_setstat(path, M_MK_CH_CURRENT, 0));
+}
+
+/******************************** TestStats *********************************
+ *
+ *  Description: Entry statistics
+ *
+ ****************************************************************************/
+static void TestStats(MDIS_PATH path, M27SIM_HW *hw)
+{
+	M27_STATS stats;
+	M_SG_BLOCK blk;
+	u_int8 buf[16];
+	u_int32 n, sum;
+
+	CALL(M_setstat(path, M27_STATS_RESET, 0));
+
+	CALL(M_write(path, 1));
+	CALL(M_write(path, 1));				/* redundant */
+	CALL(M_write(path, 0));
+	CHECK(M_getblock(path, buf, 16) == 16);
+
+	blk.size = sizeof(stats);
+	blk.data = &stats;
+	CALL(M_getstat(path, M27_BLK_STATS, (int32*)&blk));
+
+	CHECK(stats.calls[M27_ENTRY_WRITE] == 3);
+	CHECK(stats.calls[M27_ENTRY_BLKREAD] == 1);
+	CHECK(stats.calls[M27_ENTRY_SETSTAT] == 1);	/* reset */
+	CHECK(stats.calls[M27_ENTRY_GETSTAT] == 0);	/* counted on return */
+	CHECK(stats.regWrites == 2);
+	CHECK(stats.redundant == 1);
+	CHECK(stats.regReads == 0);
+	CHECK(stats.unitNs == 1000000);
+
+	for (n=0, sum=0; n<M27_STATS_BUCKETS; n++)
+		sum += stats.hist[M27_ENTRY_WRITE][n];
+	CHECK(sum == 3);
+
+	blk.size = sizeof(stats) - 1;
+	CHECK(M_getstat(path, M27_BLK_STATS, (int32*)&blk) < 0);
+	CHECK(UOS_ErrnoGet() == ERR_LL_USERBUF);
+}
+
+/******************************** TestTrace *********************************
+ *
+ *  Description: Output trace ring buffer
+ *
+ ****************************************************************************/
+static void TestTrace(MDIS_PATH path, M27SIM_HW *hw)
+{
+	static M27_TRACE_ENTRY trc[M27_TRACE_SIZE];
+	M_SG_BLOCK blk;
+	int32 val, n;
+
+	blk.data = trc;
+
+	/* disabled: nothing recorded */
+	blk.size = sizeof(trc);
+	CALL(M_getstat(path, M27_BLK_TRACE, (int32*)&blk));
+	CHECK(blk.size == 0);
+
+	CALL(M_setstat(path, M27_TRACE, 1));
+	CALL(M_getstat(path, M27_TRACE, &val));
+	CHECK(val == 1);
+
+	CALL(M_setstat(path, M_MK_CH_CURRENT, 5));
+	CALL(M_write(path, 1));
+	CALL(M_write(path, 1));				/* unchanged: not traced */
+	CALL(M_setstat(path, M27_TOGGLE_MASK, 0x0003));
+	CALL(M_setstat(path, M_MK_CH_CURRENT, 0));
+
+	/* drain one entry, then the rest */
+	blk.size = sizeof(M27_TRACE_ENTRY) + 1;
+	CALL(M_getstat(path, M27_BLK_TRACE, (int32*)&blk));
+	CHECK(blk.size == sizeof(M27_TRACE_ENTRY));
+	CHECK(trc[0].src == M27_SRC_WRITE);
+	CHECK(trc[0].oldWord == 0x0000 && trc[0].newWord == 0x0020);
+
+	blk.size = sizeof(trc);
+	CALL(M_getstat(path, M27_BLK_TRACE, (int32*)&blk));
+	CHECK(blk.size == sizeof(M27_TRACE_ENTRY));
+	CHECK(trc[0].src == M27_SRC_SETSTAT);
+	CHECK(trc[0].oldWord == 0x0020 && trc[0].newWord == 0x0023);
+
+	/* overflow: oldest entries are lost */
+	for (n=0; n<M27_TRACE_SIZE + 10; n++)
+		CALL(M_setstat(path, M27_TOGGLE_MASK, 0x8000));
+	CALL(M_getstat(path, M27_TRACE_LOST, &val));
+	CHECK(val == 10);
+
+	blk.size = sizeof(trc);
+	CALL(M_getstat(path, M27_BLK_TRACE, (int32*)&blk));
+	CHECK(blk.size == sizeof(trc));
+	CHECK(trc[0].newWord == 0x8023 && trc[M27_TRACE_SIZE-1].newWord == 0x0023);
+
+	CALL(M_setstat(path, M27_TRACE, 0));
+	CALL(M_setstat(path, M27_CLR_MASK, 0xffff));
+	blk.size = sizeof(trc);
+	CALL(M_getstat(path, M27_BLK_TRACE, (int32*)&blk));
+	CHECK(blk.size == 0);
+	CHECK(hw->reg[0] == 0x0000);
+}
+
+/******************************* TestStaging ********************************
+ *
+ *  Description: Staged changes, commit and abort
+ *
+ ****************************************************************************/
+static void TestStaging(MDIS_PATH path, M27SIM_HW *hw)
+{
+	MDIS_PATH other;
+	u_int16 word;
+	u_int32 wr;
+	int32 val;
+
+	wr = hw->wrCount;
+
+	/* staged changes don't reach the hardware */
+	CALL(M_setstat(path, M27_STAGE_MASKED, M27_MASKED(0x0018, 0x0018)));
+	CALL(M_setstat(path, M27_STAGE_MASKED, M27_MASKED(0x0008, 0x0000)));
+	CALL(M_setstat(path, M27_STAGE_MASKED, M27_MASKED(0xf000, 0xa000)));
+	CHECK(hw->wrCount == wr && hw->reg[0] == 0x0000);
+	CALL(M_read(path, &val));
+	CHECK(val == 0);					/* reads see the real outputs */
+	CALL(M_getstat(path, M27_STAGED, &val));
+	CHECK(val == 0xf018);
+
+	/* other writes go to the hardware immediately */
+	if ((other = M_open(DEVICE)) < 0) {
+		CHECK(0);
+		return;
+	}
+	CALL(M_setstat(other, M_MK_CH_CURRENT, 0));
+	CALL(M_write(other, 1));
+	CHECK(hw->reg[0] == 0x0001 && hw->wrCount == wr + 1);
+	CALL(M_setstat(other, M27_BLOCK_MODE, M27_BLOCK_PACKED));
+	word = 0x0101;
+	CHECK(M_setblock(other, (u_int8*)&word, 2) == 2);
+	CALL(M_setstat(other, M27_BLOCK_MODE, M27_BLOCK_BYTES));
+	CHECK(hw->reg[0] == 0x0101 && hw->wrCount == wr + 2);
+
+	/* commit writes the staged channels only, with one access */
+	CALL(M_setstat(path, M27_COMMIT, 0));
+	CHECK(hw->reg[0] == 0xa111 && hw->wrCount == wr + 3);
+	CALL(M_getstat(path, M27_STAGED, &val));
+	CHECK(val == 0);
+	CALL(M_setstat(path, M27_COMMIT, 0));	/* nothing staged */
+	CHECK(hw->wrCount == wr + 3);
+
+	/* abort discards the staged changes, other writes are kept */
+	CALL(M_setstat(path, M27_STAGE_MASKED, M27_MASKED(0x0011, 0x0000)));
+	CALL(M_write(other, 0));
+	CALL(M_setstat(path, M27_ABORT, 0));
+	CALL(M_setstat(path, M27_COMMIT, 0));
+	CHECK(hw->reg[0] == 0xa110 && hw->wrCount == wr + 4);
+
+	CALL(M_close(other));
+	CALL(M_setstat(path, M27_CLR_MASK, 0xffff));
+	CHECK(hw->reg[0] == 0x0000);
+}
+
+/******************************* TestCmdList ********************************
+ *
+ *  Description: Command list in one block getstat
+ *
+ ****************************************************************************/
+static void TestCmdList(MDIS_PATH path, M27SIM_HW *hw)
+{
+	M27_CMD cmd[8];
+	M_SG_BLOCK blk;
+	u_int32 wr = hw->wrCount;
+
+	memset(cmd, 0, sizeof(cmd));
+	cmd[0].op = M27_CMD_WRITE;		cmd[0].value = 0x0f00;
+	cmd[1].op = M27_CMD_SET;		cmd[1].mask = 0x0003;
+	cmd[2].op = M27_CMD_CLR;		cmd[2].mask = 0x0100;
+	cmd[3].op = M27_CMD_DELAY_US;	cmd[3].value = 50;
+	cmd[4].op = M27_CMD_TOGGLE;		cmd[4].mask = 0x8001;
+	cmd[5].op = M27_CMD_PULSE;		cmd[5].mask = 0x0010;	cmd[5].value = 10;
+	cmd[6].op = M27_CMD_MASKED;		cmd[6].mask = 0x00f0;	cmd[6].value = 0x5aa5;
+	cmd[7].op = M27_CMD_READ;		cmd[7].result = 0xffffffff;
+
+	blk.data = cmd;
+	blk.size = sizeof(cmd);
+	CALL(M_getstat(path, M27_BLK_CMDLIST, (int32*)&blk));
+	CHECK(cmd[0].status == 0 && cmd[7].status == 0);
+	CHECK(cmd[7].result == 0x8ea2);
+	CHECK(hw->reg[0] == 0x8ea2);
+	CHECK(hw->wrCount == wr + 7);		/* one write per output command */
+
+	/* stop at the first error */
+	cmd[1].op = M27_CMD_SLEEP_MS;	cmd[1].value = 1;
+	cmd[2].op = M27_CMD_DELAY_US;	cmd[2].value = 1001;
+	CHECK(M_getstat(path, M27_BLK_CMDLIST, (int32*)&blk) < 0);
+	CHECK(UOS_ErrnoGet() == ERR_LL_ILL_PARAM);
+	CHECK(cmd[0].status == 0 && cmd[1].status == 0);
+	CHECK(cmd[2].status == ERR_LL_ILL_PARAM);
+	CHECK(cmd[3].status == -1 && cmd[7].status == -1);
+	CHECK(hw->reg[0] == 0x0f00);
+
+	/* sleeps are limited per list */
+	cmd[1].value = 1001;
+	cmd[2].op = M27_CMD_SLEEP_MS;	cmd[2].value = 0;
+	cmd[3].op = M27_CMD_SLEEP_MS;	cmd[3].value = 1;
+	CHECK(M_getstat(path, M27_BLK_CMDLIST, (int32*)&blk) < 0);
+	CHECK(cmd[1].status == ERR_LL_ILL_PARAM && cmd[2].status == -1);
+	cmd[0].op = M27_CMD_SLEEP_MS;	cmd[0].value = 999;
+	cmd[1].value = 1;
+	CHECK(M_getstat(path, M27_BLK_CMDLIST, (int32*)&blk) < 0);
+	CHECK(cmd[1].status == 0 && cmd[2].status == 0);
+	CHECK(cmd[3].status == ERR_LL_ILL_PARAM);
+
+	cmd[0].op = 0;
+	CHECK(M_getstat(path, M27_BLK_CMDLIST, (int32*)&blk) < 0);
+	CHECK(cmd[0].status == ERR_LL_ILL_PARAM);
+	blk.size = sizeof(M27_CMD) - 1;
+	CHECK(M_getstat(path, M27_BLK_CMDLIST, (int32*)&blk) < 0);
+	CHECK(UOS_ErrnoGet() == ERR_LL_USERBUF);
+
+	CALL(M_setstat(path, M27_CLR_MASK, 0xffff));
+}
+
+/****************************** TestWaitChange ******************************
+ *
+ *  Description: Output generation and blocking wait for change
+ *
+ ****************************************************************************/
+typedef struct {
+	MDIS_PATH		path;
+	M27_WAIT_CHANGE	wc;
+	int32			ret;
+} WAIT_ARG;
+
+static void TestWaitChange(MDIS_PATH path, M27SIM_HW *hw)
+{
+	M27_WAIT_CHANGE wc;
+	M_SG_BLOCK blk;
+	WAIT_ARG arg[2];
+	pthread_t tid[2];
+	M27_STATS stats;
+	int32 gen;
+	u_int32 t, waits, getstats, sum;
+	int n;
+
+	blk.data = &stats;
+	blk.size = sizeof(stats);
+	CALL(M_getstat(path, M27_BLK_STATS, (int32*)&blk));
+	waits    = stats.waits;
+	getstats = stats.calls[M27_ENTRY_GETSTAT] + 1;	/* this call */
+
+	CALL(M_getstat(path, M27_GENERATION, &gen));
+	blk.data = &wc;
+	blk.size = sizeof(wc);
+
+	/* no change: timeout, current state returned */
+	wc.gen = gen;
+	wc.timeout = 0;
+	CHECK(M_getstat(path, M27_BLK_WAIT_CHANGE, (int32*)&blk) < 0);
+	CHECK(UOS_ErrnoGet() == ERR_OSS_TIMEOUT);
+	CHECK(wc.gen == (u_int32)gen && wc.word == 0x0000);
+
+	t = UOS_MsecTimerGet();
+	wc.timeout = 30;
+	CHECK(M_getstat(path, M27_BLK_WAIT_CHANGE, (int32*)&blk) < 0);
+	CHECK(UOS_ErrnoGet() == ERR_OSS_TIMEOUT);
+	CHECK(UOS_MsecTimerGet() - t >= 25);
+
+	/* change already happened: returns immediately */
+	CALL(M_setstat(path, M27_SET_MASK, 0x0021));
+	CALL(M_setstat(path, M27_SET_MASK, 0x0001));		/* redundant */
+	wc.timeout = -1;
+	CALL(M_getstat(path, M27_BLK_WAIT_CHANGE, (int32*)&blk));
+	CHECK(wc.gen == (u_int32)gen + 1 && wc.word == 0x0021);
+	CHECK(blk.size == sizeof(wc));
+
+	/* two waiters are woken up by one change */
+	for (n=0; n<2; n++) {
+		arg[n].path = path;
+		arg[n].wc.gen = gen + 1;
+		arg[n].wc.timeout = n ? -1 : 5000;
+		pthread_create(&tid[n], NULL, WaitThread, &arg[n]);
+	}
+	UOS_Delay(20);
+	CALL(M_write(path, 0));							/* channel 0 off */
+	for (n=0; n<2; n++) {
+		pthread_join(tid[n], NULL);
+		CHECK(arg[n].ret == 0);
+		CHECK(arg[n].wc.gen == (u_int32)gen + 2);
+		CHECK(arg[n].wc.word == 0x0020);
+	}
+	CHECK(hw->reg[0] == 0x0020);
+
+	blk.size = sizeof(wc) - 1;
+	CHECK(M_getstat(path, M27_BLK_WAIT_CHANGE, (int32*)&blk) < 0);
+	CHECK(UOS_ErrnoGet() == ERR_LL_USERBUF);
+
+	CALL(M_setstat(path, M27_CLR_MASK, 0xffff));
+	CALL(M_getstat(path, M27_GENERATION, &gen));
+	CHECK(arg[0].wc.gen + 1 == (u_int32)gen);
+
+	/* waits are counted apart from the other getstat calls */
+	blk.data = &stats;
+	blk.size = sizeof(stats);
+	CALL(M_getstat(path, M27_BLK_STATS, (int32*)&blk));
+	CHECK(stats.waits == waits + 6);
+	CHECK(stats.calls[M27_ENTRY_GETSTAT] == getstats + 2);	/* generation */
+	for (n=0, sum=0; n<M27_STATS_BUCKETS; n++)
+		sum += stats.hist[M27_ENTRY_GETSTAT][n];
+	CHECK(sum == stats.calls[M27_ENTRY_GETSTAT]);
+}
+
+static void *WaitThread(void *arg)
+{
+	WAIT_ARG *wa = (WAIT_ARG*)arg;
+	M_SG_BLOCK blk;
+
+	blk.data = &wa->wc;
+	blk.size = sizeof(wa->wc);
+	wa->ret = M_getstat(wa->path, M27_BLK_WAIT_CHANGE, (int32*)&blk);
+	return(NULL);
+}
+
+/******************************** TestGroup *********************************
+ *
+ *  Description: Output group library shares the device with other paths
+ *
+ ****************************************************************************/
+static void TestGroup(MDIS_PATH path, M27SIM_HW *hw)
+{
+	char *devices[1] = { DEVICE };
+	M27GRP_HANDLE *grp;
+	M27GRP_STATS stats;
+	u_int16 mask = 0x0f00, value = 0x0500, image;
+	u_int32 wr;
+	int32 val;
+
+	CALL(M_setstat(path, M27_SET_MASK, 0x0001));
+	CALL(M27GRP_Open(devices, 1, &grp));
+	if (grp == NULL)
+		return;
+
+	CALL(M_getstat(path, M27_BLOCK_MODE, &val));
+	CHECK(val == M27_BLOCK_BYTES);			/* block mode untouched */
+	CALL(M27GRP_Get(grp, &image));
+	CHECK(image == 0x0001);
+
+	/* foreign change between staging and commit is kept */
+	CALL(M27GRP_Set(grp, 4));
+	CALL(M27GRP_WriteMasked(grp, &mask, &value));
+	CALL(M_setstat(path, M27_TOGGLE_MASK, 0x8001));
+	wr = hw->wrCount;
+	CHECK(M27GRP_Commit(grp) == 1);
+	CHECK(hw->reg[0] == 0x8510 && hw->wrCount == wr + 1);
+
+	/* nothing touched: nothing written */
+	CHECK(M27GRP_Commit(grp) == 0);
+	CHECK(hw->wrCount == wr + 1);
+
+	/* channels staged to their committed state: nothing written */
+	CALL(M_setstat(path, M27_CLR_MASK, 0x0010));
+	wr = hw->wrCount;
+	CALL(M27GRP_Set(grp, 4));
+	CALL(M27GRP_WriteMasked(grp, &mask, &value));
+	CHECK(M27GRP_Commit(grp) == 0);
+	CHECK(hw->reg[0] == 0x8500 && hw->wrCount == wr);
+
+	/* only the changed channel is written */
+	CALL(M27GRP_Set(grp, 4));
+	CALL(M27GRP_Clear(grp, 8));
+	CHECK(M27GRP_Commit(grp) == 1);
+	CHECK(hw->reg[0] == 0x8400 && hw->wrCount == wr + 1);
+
+	CALL(M27GRP_Stats(grp, &stats));
+	CHECK(stats.commits == 4 && stats.writes == 2);
+	CHECK(stats.lastWrites == 1 && stats.errors == 0);
+
+	CALL(M27GRP_Close(&grp));
+	CHECK(grp == NULL);
+	CALL(M_setstat(path, M27_CLR_MASK, 0xffff));
+}
+
+/******************************* TestIdCheck ********************************
+ *
+ *  Description: Wrong module id is rejected
+ *
+ ****************************************************************************/
+static void TestIdCheck(void)
+{
+	setenv("M27SIM_MODID", "99", 1);
+	CHECK(M_open("m27_wrong") < 0);
+	CHECK(UOS_ErrnoGet() == ERR_LL_ILL_ID);
+	unsetenv("M27SIM_MODID");
+}
+
+/***************************** TestWarmRestart ******************************
+ *
+ *  Description: OUTPUT_INIT/INIT_VALUE/OUTPUT_EXIT descriptor keys
+ *
+ ****************************************************************************/
+static void TestWarmRestart(void)
+{
+	static DESC_SPEC desc[] = {
+		{ "OUTPUT_INIT", M27_OUTINIT_ADOPT },
+		{ "INIT_VALUE", 0 },
+		{ "OUTPUT_EXIT", M27_OUTEXIT_LEAVE },
+		{ NULL, 0 } };
+	LL_ENTRY entry;
+	LL_HANDLE *llHdl = NULL;
+	M27SIM_HW hw;
+	MACCESS ma = &hw;
+	int32 v;
+
+	M27SIM_HwInit(&hw, 27);
+	M27_GetEntry(&entry);
+
+	/* adopt, leave on exit */
+	hw.reg[0] = 0x1234;
+	CHECK(entry.init(desc, NULL, &ma, NULL, NULL, &llHdl) == ERR_SUCCESS);
+	CHECK(hw.reg[0] == 0x1234 && hw.wrCount == 0);
+	CHECK(entry.read(llHdl, 2, &v) == ERR_SUCCESS && v == 1);
+	CHECK(entry.read(llHdl, 0, &v) == ERR_SUCCESS && v == 0);
+	CHECK(entry.write(llHdl, 0, 1) == ERR_SUCCESS);
+	CHECK(hw.reg[0] == 0x1235);
+	CHECK(entry.exit(&llHdl) == ERR_SUCCESS);
+	CHECK(hw.reg[0] == 0x1235);
+
+	/* initial pattern in one write */
+	hw.wrCount = 0;
+	desc[0].value = M27_OUTINIT_VALUE;
+	desc[1].value = 0x00f0;
+	CHECK(entry.init(desc, NULL, &ma, NULL, NULL, &llHdl) == ERR_SUCCESS);
+	CHECK(hw.reg[0] == 0x00f0 && hw.wrCount == 1);
+	CHECK(entry.exit(&llHdl) == ERR_SUCCESS);
+	CHECK(hw.reg[0] == 0x00f0);
+
+	/* INIT_VALUE is ignored for reset, outputs reset on exit */
+	desc[0].value = M27_OUTINIT_RESET;
+	desc[2].value = M27_OUTEXIT_RESET;
+	CHECK(entry.init(desc, NULL, &ma, NULL, NULL, &llHdl) == ERR_SUCCESS);
+	CHECK(hw.reg[0] == 0x0000);
+	CHECK(entry.write(llHdl, 4, 1) == ERR_SUCCESS);
+	CHECK(entry.exit(&llHdl) == ERR_SUCCESS);
+	CHECK(hw.reg[0] == 0x0000);
+
+	/* illegal values */
+	desc[0].value = 3;
+	CHECK(entry.init(desc, NULL, &ma, NULL, NULL, &llHdl) == ERR_LL_ILL_PARAM);
+	desc[0].value = M27_OUTINIT_VALUE;
+	desc[1].value = 0x10000;
+	CHECK(entry.init(desc, NULL, &ma, NULL, NULL, &llHdl) == ERR_LL_ILL_PARAM);
+	desc[1].value = 0;
+	desc[2].value = 2;
+	CHECK(entry.init(desc, NULL, &ma, NULL, NULL, &llHdl) == ERR_LL_ILL_PARAM);
+}
+
+/******************************* TestLockMode *******************************
+ *
+ *  Description: Concurrent writers on separate channels
+ *
+ *               Each thread owns one channel and toggles it through its
+ *               own path, then writes the final state of its channel.
+ *               No update of another channel may be lost. The register
+ *               writes and skipped writes are counted under the output
+ *               lock and must match exactly, the entry calls are counted
+ *               without lock and may be lost.
+ *
+ ****************************************************************************/
+#define LOCK_THREADS	4			/* nr of writer threads */
+#define LOCK_LOOPS		2000		/* toggles per thread (even) */
+
+typedef struct {
+	MDIS_PATH		path;
+	int32			ch;
+	int32			errors;
+} WRITER_ARG;
+
+static void TestLockMode(u_int32 lockMode)
+{
+	WRITER_ARG arg[LOCK_THREADS];
+	pthread_t tid[LOCK_THREADS];
+	M27_STATS stats;
+	M_SG_BLOCK blk;
+	M27SIM_HW *hw;
+	MDIS_PATH path;
+	u_int32 wr, writes;
+	int32 val;
+	int n;
+
+	M27SIM_DescSet("LOCK_MODE", lockMode);
+	path = M_open("m27_lock");
+	M27SIM_DescSet("LOCK_MODE", M27_LOCKMODE_CALL);
+	CALL(path);
+	if (path < 0)
+		return;
+	hw = M27SIM_DevHw("m27_lock");
+
+	CALL(M_getstat(path, M27_LOCK_MODE, &val));
+	CHECK(val == (int32)lockMode);
+	CALL(M_setstat(path, M27_STATS_RESET, 0));
+	wr = hw->wrCount;
+
+	for (n=0; n<LOCK_THREADS; n++) {
+		arg[n].path   = M_open("m27_lock");
+		arg[n].ch     = n;
+		arg[n].errors = 0;
+		CALL(arg[n].path);
+		CALL(M_setstat(arg[n].path, M_MK_CH_CURRENT, n));
+	}
+	for (n=0; n<LOCK_THREADS; n++)
+		pthread_create(&tid[n], NULL, WriterThread, &arg[n]);
+	for (n=0; n<LOCK_THREADS; n++) {
+		pthread_join(tid[n], NULL);
+		CHECK(arg[n].errors == 0);
+		CALL(M_close(arg[n].path));
+	}
+
+	/* odd channels end set, even channels reset */
+	CHECK(hw->reg[0] == 0x000a);
+
+	/*
+	 * per thread: first write (0) skipped, LOOPS-1 toggles, final
+	 * write skipped for odd channels
+	 */
+	writes = LOCK_THREADS * (LOCK_LOOPS + 1);
+	blk.data = &stats;
+	blk.size = sizeof(stats);
+	CALL(M_getstat(path, M27_BLK_STATS, (int32*)&blk));
+	CHECK(stats.regWrites == LOCK_THREADS * (LOCK_LOOPS - 1) +
+		  LOCK_THREADS / 2);
+	CHECK(stats.redundant == LOCK_THREADS + LOCK_THREADS / 2);
+	CHECK(stats.regWrites + stats.redundant == writes);
+	CHECK(hw->wrCount - wr == stats.regWrites);
+	CHECK(stats.calls[M27_ENTRY_WRITE] > 0);
+	CHECK(stats.calls[M27_ENTRY_WRITE] <= writes);
+
+	CALL(M_close(path));
+	CHECK(M27SIM_DevHw("m27_lock") == NULL);
+}
+
+static void *WriterThread(void *arg)
+{
+	WRITER_ARG *wa = (WRITER_ARG*)arg;
+	int32 n;
+
+	for (n=0; n<LOCK_LOOPS; n++)
+		if (M_write(wa->path, n & 1) < 0)
+			wa->errors++;
+
+	if (M_write(wa->path, wa->ch & 1) < 0)
+		wa->errors++;
+
+	return(NULL);
+}
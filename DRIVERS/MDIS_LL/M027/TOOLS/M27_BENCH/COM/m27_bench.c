@@ -0,0 +1,746 @@
+/****************************************************************************
+ ************                                                    ************
+ ************                 M 2 7 _ B E N C H                  ************
+ ************                                                    ************
+ ****************************************************************************
+ *
+ *  Description: Latency and throughput benchmark for M27 devices
+ *
+ *               Each test repeats one access pattern for a number of
+ *               iterations or seconds and measures every single call.
+ *               Reported are ops/s and min/median/p99/p99.9/max latency,
+ *               either as table or as CSV (one line per test).
+ *
+ *               Tests:
+ *                 w  M_write        alternating 0/1 on the current channel
+ *                 r  M_read         current channel
+ *                 S  M_setblock     16 bytes, alternating pattern
+ *                 G  M_getblock     16 bytes
+ *                 c  M_setstat(M_MK_CH_CURRENT) + M_write, channels 0..15
+ *
+ *               The written values alternate, so the driver can't skip
+ *               any register write.
+ *
+ *               With -p=<n>, n threads run each test at the same time,
+ *               each with its own path and current channel (thread k uses
+ *               channel k%16, so w/r touch disjoint channels). The
+ *               result line sums the throughput of all threads and
+ *               merges their latencies; this shows how the driver lock
+ *               mode (LOCK_MODE) scales.
+ *
+ *               With -f, the n workers are separate processes (fork)
+ *               instead of threads, as with independent applications
+ *               sharing one module. Results, samples and the start
+ *               barrier are then kept in shared memory; each worker
+ *               records at most 1/n of the sample limit.
+ *
+ *     Required: libraries: mdis_api, usr_oss, usr_utl (LINUX: pthread)
+ *     Switches: LINUX		use CLOCK_MONOTONIC (ns) for time measurement,
+ *                          otherwise the ms timer of usr_oss is used;
+ *                          enables multi-thread/process options -p, -f
+ *
+ *---------------------------------------------------------------------------
+ * Copyright 2026, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#ifdef LINUX
+#	include <time.h>
+#	include <errno.h>
+#	include <signal.h>
+#	include <unistd.h>
+#	include <pthread.h>
+#	include <sys/mman.h>
+#	include <sys/wait.h>
+#endif
+#include <MEN/men_typs.h>
+#include <MEN/usr_oss.h>
+#include <MEN/usr_utl.h>
+#include <MEN/mdis_api.h>
+#include <MEN/m27_drv.h>
+
+static const char IdentString[]=MENT_XSTR(MAK_REVISION);
+
+/*--------------------------------------+
+|   DEFINES                             |
++--------------------------------------*/
+#define CH_NUMBER		16			/* nr of device channels */
+#define TESTS			"wrSGc"		/* all tests */
+#define SAMPLES_MAX		(16*1024*1024)	/* max. nr of recorded samples */
+#define THREADS_MAX		64			/* max. nr of threads/processes (-p) */
+
+/*--------------------------------------+
+|   TYPEDEFS                            |
++--------------------------------------*/
+typedef struct {
+	char		*name;			/* test name */
+	u_int32		ops;			/* nr of calls */
+	u_int64		totalNs;		/* duration of all calls [ns] */
+	u_int32		*sample;		/* latency of each call [ns] */
+	u_int32		samples;		/* nr of recorded samples */
+	u_int32		alloc;			/* allocated samples */
+	int			fixed;			/* buffer can't grow (shared, -f) */
+} BENCH_RESULT;
+
+typedef struct {
+	int			nr;				/* thread nr */
+	char		*device;		/* device name */
+	MDIS_PATH	path;			/* own path */
+	BENCH_RESULT res;			/* result of current test */
+	int32		error;			/* test failed */
+} BENCH_THREAD;
+
+/*--------------------------------------+
+|   GLOBALS                             |
++--------------------------------------*/
+static char			*G_tests;			/* tests to run */
+static u_int32		G_iter;				/* iterations per test */
+static u_int32		G_secs;				/* seconds per test */
+static int			G_csv;				/* CSV output */
+static int			G_threads = 1;		/* nr of threads/processes */
+static int			G_procs;			/* workers are processes (-f) */
+static BENCH_THREAD	G_thrLocal[THREADS_MAX];
+static BENCH_THREAD	*G_thr = G_thrLocal;	/* workers (shared with -f) */
+#ifdef LINUX
+static pthread_barrier_t G_barrierLocal;
+static pthread_barrier_t *G_barrier = &G_barrierLocal;
+static u_int32		*G_shmSample;		/* -f: sample buffers */
+static u_int32		G_shmAlloc;			/* -f: samples per worker */
+#endif
+
+/*--------------------------------------+
+|   PROTOTYPES                          |
++--------------------------------------*/
+static void usage(void);
+static void PrintError(char *info);
+static void *Worker(void *arg);
+static void Barrier(void);
+#ifdef LINUX
+static int32 ShareWorkers(void);
+static void *ShmAlloc(size_t size);
+#endif
+static int32 RunTest(MDIS_PATH path, int ch, char test, BENCH_RESULT *res);
+static int32 DoOp(MDIS_PATH path, char test, u_int32 n);
+static int32 AddSample(BENCH_RESULT *res, u_int32 ns);
+static void Merge(BENCH_RESULT *res, BENCH_RESULT *add);
+static void Report(BENCH_RESULT *res, char *device);
+static u_int32 Percentile(BENCH_RESULT *res, u_int32 permill);
+static int CmpU32(const void *a, const void *b);
+static u_int64 TimeNs(void);
+
+/********************************* usage ************************************
+ *
+ *  Description: Print program usage
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: -
+ *  Output.....: -
+ *  Globals....: -
+ ****************************************************************************/
+static void usage(void)
+{
+	printf("Usage:    m27_bench [<opts>] <device> [<opts>]\n");
+	printf("Function: Latency and throughput benchmark for M27 devices\n");
+	printf("Options:\n");
+	printf("  device         device name                             [none]\n");
+	printf("  -t=<tests>     tests to run (any of " TESTS ")          [" TESTS "]\n");
+	printf("                   w  M_write\n");
+	printf("                   r  M_read\n");
+	printf("                   S  M_setblock (16 bytes)\n");
+	printf("                   G  M_getblock (16 bytes)\n");
+	printf("                   c  M_setstat(M_MK_CH_CURRENT) + M_write\n");
+	printf("  -n=<iter>      iterations per test                     [100000]\n");
+	printf("  -T=<sec>       run each test <sec> seconds (overrides -n) [-]\n");
+	printf("  -c             CSV output                              [no]\n");
+#ifdef LINUX
+	printf("  -p=<n>         run tests in n threads (1..%d)          [1]\n",
+		   THREADS_MAX);
+	printf("  -f             -p workers are processes (fork)         [threads]\n");
+#endif
+	printf("\n");
+	printf("Copyright 2026, MEN Mikro Elektronik GmbH\n%s\n", IdentString);
+}
+
+/********************************* main *************************************
+ *
+ *  Description: Program main function
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: argc,argv	argument counter, data ..
+ *  Output.....: return	    success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+int main(int argc, char *argv[])
+{
+	int32 n, ret = 0;
+	char *device, *str, *errstr;
+	char buf[40];
+#ifdef LINUX
+	pthread_t tid[THREADS_MAX];
+	pid_t pid[THREADS_MAX];
+	int status;
+#endif
+
+	/*--------------------+
+    |  check arguments    |
+    +--------------------*/
+	if ((errstr = UTL_ILLIOPT("t=n=T=cp=f?", buf))) {	/* check args */
+		printf("*** %s\n", errstr);
+		return(1);
+	}
+
+	if (UTL_TSTOPT("?")) {						/* help requested ? */
+		usage();
+		return(1);
+	}
+
+	/*--------------------+
+    |  get arguments      |
+    +--------------------*/
+	for (device=NULL, n=1; n<argc; n++)
+		if (*argv[n] != '-') {
+			device = argv[n];
+			break;
+		}
+
+	if (!device) {
+		usage();
+		return(1);
+	}
+
+	G_tests = ((str = UTL_TSTOPT("t=")) ? str : TESTS);
+	G_iter  = ((str = UTL_TSTOPT("n=")) ? atoi(str) : 100000);
+	G_secs  = ((str = UTL_TSTOPT("T=")) ? atoi(str) : 0);
+	G_csv   = (UTL_TSTOPT("c") ? 1 : 0);
+#ifdef LINUX
+	G_threads = ((str = UTL_TSTOPT("p=")) ? atoi(str) : 1);
+	G_procs   = (UTL_TSTOPT("f") ? 1 : 0);
+#endif
+
+	if (strspn(G_tests, TESTS) != strlen(G_tests) || (!G_secs && !G_iter) ||
+		(G_threads < 1) || (G_threads > THREADS_MAX)) {
+		usage();
+		return(1);
+	}
+
+#ifdef LINUX
+	if (G_procs && ShareWorkers() < 0) {
+		printf("*** can't alloc shared memory: %s\n", strerror(errno));
+		return(1);
+	}
+#endif
+
+	/*--------------------+
+    |  open paths         |
+    +--------------------*/
+	for (n=0; n<G_threads; n++) {
+		G_thr[n].nr     = n;
+		G_thr[n].device = device;
+		if ((G_thr[n].path = M_open(device)) < 0) {
+			PrintError("open");
+			while (n--)
+				M_close(G_thr[n].path);
+			return(1);
+		}
+	}
+
+	if (G_csv)
+		printf("device,test,ops,seconds,ops_per_s,"
+			   "min_ns,median_ns,p99_ns,p99_9_ns,max_ns,threads\n");
+	else
+		printf("%-14s %10s %10s %9s %9s %9s %9s %9s\n", "test", "ops",
+			   "ops/s", "min[ns]", "med[ns]", "p99[ns]", "p99.9[ns]",
+			   "max[ns]");
+
+	/*--------------------+
+    |  run tests          |
+    +--------------------*/
+#ifdef LINUX
+	if (!G_procs)
+		pthread_barrier_init(G_barrier, NULL, G_threads);
+
+	fflush(stdout);		/* don't duplicate buffered output in children */
+
+	for (n=1; n<G_threads; n++) {
+		if (G_procs) {
+			if ((pid[n] = fork()) == 0) {
+				Worker(&G_thr[n]);
+				fflush(stdout);
+				_exit(0);
+			}
+			status = (pid[n] < 0) ? errno : 0;
+		}
+		else
+			status = pthread_create(&tid[n], NULL, Worker, &G_thr[n]);
+
+		/* started workers wait for all: give up */
+		if (status) {
+			printf("*** can't start worker %d: %s\n", (int)n,
+				   strerror(status));
+			if (G_procs)
+				while (--n)
+					kill(pid[n], SIGKILL);
+			return(1);
+		}
+	}
+#endif
+
+	Worker(&G_thr[0]);
+
+#ifdef LINUX
+	for (n=1; n<G_threads; n++) {
+		if (!G_procs)
+			pthread_join(tid[n], NULL);
+		else if (waitpid(pid[n], &status, 0) < 0 ||
+				 !WIFEXITED(status) || WEXITSTATUS(status))
+			ret = 1;
+	}
+
+	pthread_barrier_destroy(G_barrier);
+#endif
+
+	/*--------------------+
+    |  cleanup            |
+    +--------------------*/
+	for (n=0; n<G_threads; n++) {
+		if (G_thr[n].error)
+			ret = 1;
+
+		M_setstat(G_thr[n].path, M_MK_CH_CURRENT, n % CH_NUMBER);
+		M_write(G_thr[n].path, 0);
+
+		if (M_close(G_thr[n].path) < 0)
+			PrintError("close");
+	}
+
+	return(ret);
+}
+
+/********************************** Worker **********************************
+ *
+ *  Description: Run all tests in one thread
+ *
+ *               All threads start each test together. Thread 0 merges
+ *               and reports the results. After an error, the remaining
+ *               tests are skipped by all threads. With -f the thread is
+ *               a process and records into its shared sample buffer.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: arg	thread (BENCH_THREAD)
+ *  Output.....: return NULL
+ *  Globals....: G_tests, G_thr
+ ****************************************************************************/
+static void *Worker(void *arg)
+{
+	BENCH_THREAD *thr = (BENCH_THREAD*)arg;
+	BENCH_RESULT all;
+	char *test;
+	int32 n, error;
+
+	for (test=G_tests; *test; test++) {
+		memset(&thr->res, 0, sizeof(thr->res));
+#ifdef LINUX
+		if (G_procs) {
+			thr->res.sample = G_shmSample + thr->nr * G_shmAlloc;
+			thr->res.alloc  = G_shmAlloc;
+			thr->res.fixed  = TRUE;
+		}
+#endif
+
+		Barrier();
+		if (RunTest(thr->path, thr->nr % CH_NUMBER, *test, &thr->res) < 0)
+			thr->error = TRUE;
+		Barrier();
+
+		for (n=0, error=FALSE; n<G_threads; n++)
+			error |= G_thr[n].error;
+
+		if (thr->nr == 0 && !error) {
+			memset(&all, 0, sizeof(all));
+			all.name = thr->res.name;
+			for (n=0; n<G_threads; n++)
+				Merge(&all, &G_thr[n].res);
+			Report(&all, thr->device);
+			free(all.sample);
+		}
+
+		/* thread 0 has merged all samples before they are freed */
+		Barrier();
+
+		if (!thr->res.fixed)
+			free(thr->res.sample);
+		thr->res.sample = NULL;
+
+		if (error)
+			break;
+	}
+
+	return(NULL);
+}
+
+/********************************* Barrier **********************************
+ *
+ *  Description: Wait until all threads arrived
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: -
+ *  Output.....: -
+ *  Globals....: G_barrier
+ ****************************************************************************/
+static void Barrier(void)
+{
+#ifdef LINUX
+	if (G_threads > 1)
+		pthread_barrier_wait(G_barrier);
+#endif
+}
+
+#ifdef LINUX
+/******************************* ShareWorkers *******************************
+ *
+ *  Description: Move worker table and barrier into shared memory (-f)
+ *
+ *               Must be called before the workers are forked. The sample
+ *               limit is split between the G_threads workers.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: -
+ *  Output.....: return 0 | -1 (error, see errno)
+ *  Globals....: G_thr, G_barrier, G_shmSample, G_shmAlloc
+ ****************************************************************************/
+static int32 ShareWorkers(void)
+{
+	pthread_barrierattr_t attr;
+
+	G_shmAlloc = SAMPLES_MAX / G_threads;
+
+	if ((G_thr = (BENCH_THREAD*)ShmAlloc(THREADS_MAX *
+										 sizeof(BENCH_THREAD))) == NULL ||
+		(G_barrier = (pthread_barrier_t*)ShmAlloc(
+			 sizeof(pthread_barrier_t))) == NULL ||
+		(G_shmSample = (u_int32*)ShmAlloc((size_t)G_shmAlloc * G_threads *
+										  sizeof(u_int32))) == NULL)
+		return(-1);
+
+	pthread_barrierattr_init(&attr);
+	pthread_barrierattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+	errno = pthread_barrier_init(G_barrier, &attr, G_threads);
+	pthread_barrierattr_destroy(&attr);
+
+	return(errno ? -1 : 0);
+}
+
+/********************************* ShmAlloc *********************************
+ *
+ *  Description: Allocate zeroed memory shared with forked children
+ *
+ *               Pages are only backed when touched.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: size	size [bytes]
+ *  Output.....: return memory or NULL (see errno)
+ *  Globals....: -
+ ****************************************************************************/
+static void *ShmAlloc(size_t size)
+{
+	void *addr = mmap(NULL, size, PROT_READ | PROT_WRITE,
+					  MAP_SHARED | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+	return(addr == MAP_FAILED ? NULL : addr);
+}
+#endif
+
+/********************************* RunTest **********************************
+ *
+ *  Description: Run one test
+ *
+ *               One warm-up call is made before measuring.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: path	path
+ *               ch     current channel for w/r
+ *               test   test (see TESTS)
+ *  Output.....: res    results
+ *               return 0 | -1 (error)
+ *  Globals....: G_iter, G_secs
+ ****************************************************************************/
+static int32 RunTest(MDIS_PATH path, int ch, char test, BENCH_RESULT *res)
+{
+	u_int32 iter = G_iter, secs = G_secs;
+	u_int64 start, t0, t1, end = 0;
+	u_int32 n;
+
+	switch (test) {
+		case 'w': res->name = "write";			break;
+		case 'r': res->name = "read";			break;
+		case 'S': res->name = "setblock";		break;
+		case 'G': res->name = "getblock";		break;
+		case 'c': res->name = "setstat+write";	break;
+	}
+
+	if (M_setstat(path, M_MK_CH_CURRENT, ch) < 0) {
+		PrintError("setstat M_MK_CH_CURRENT");
+		return(-1);
+	}
+
+	if (DoOp(path, test, 0) < 0)
+		return(-1);
+
+	start = TimeNs();
+	if (secs)
+		end = start + (u_int64)secs * 1000000000;
+
+	for (n=1, t0=start; secs ? (t0 < end) : (n <= iter); n++, t0=t1) {
+		if (DoOp(path, test, n) < 0)
+			return(-1);
+
+		t1 = TimeNs();
+
+		if (AddSample(res, (u_int32)(t1 - t0)) < 0) {
+			printf("*** can't alloc sample buffer\n");
+			return(-1);
+		}
+	}
+
+	res->totalNs = t0 - start;
+	return(0);
+}
+
+/*********************************** DoOp ***********************************
+ *
+ *  Description: Perform one access of a test
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: path	path
+ *               test   test (see TESTS)
+ *               n      iteration
+ *  Output.....: return 0 | -1 (error)
+ *  Globals....: -
+ ****************************************************************************/
+static int32 DoOp(MDIS_PATH path, char test, u_int32 n)
+{
+	static u_int8 blk[2][CH_NUMBER] = {
+		{ 1,0,1,0,1,0,1,0,1,0,1,0,1,0,1,0 },
+		{ 0,1,0,1,0,1,0,1,0,1,0,1,0,1,0,1 }
+	};
+	u_int8 inbuf[CH_NUMBER];
+	int32 value;
+
+	switch (test) {
+		case 'w':
+			if (M_write(path, n & 1) < 0) {
+				PrintError("write");
+				return(-1);
+			}
+			break;
+		case 'r':
+			if (M_read(path, &value) < 0) {
+				PrintError("read");
+				return(-1);
+			}
+			break;
+		case 'S':
+			if (M_setblock(path, blk[n & 1], CH_NUMBER) < 0) {
+				PrintError("setblock");
+				return(-1);
+			}
+			break;
+		case 'G':
+			if (M_getblock(path, inbuf, CH_NUMBER) < 0) {
+				PrintError("getblock");
+				return(-1);
+			}
+			break;
+		case 'c':
+			/* 0..15 set, 16..31 reset */
+			if (M_setstat(path, M_MK_CH_CURRENT, n % CH_NUMBER) < 0) {
+				PrintError("setstat M_MK_CH_CURRENT");
+				return(-1);
+			}
+			if (M_write(path, !((n / CH_NUMBER) & 1)) < 0) {
+				PrintError("write");
+				return(-1);
+			}
+			break;
+	}
+
+	return(0);
+}
+
+/******************************** AddSample *********************************
+ *
+ *  Description: Record one latency sample
+ *
+ *               The sample buffer grows as required. Beyond SAMPLES_MAX
+ *               (or a full shared buffer) the calls are still counted but
+ *               no more samples recorded.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: res	results
+ *               ns     latency [ns]
+ *  Output.....: return 0 | -1 (no memory)
+ *  Globals....: -
+ ****************************************************************************/
+static int32 AddSample(BENCH_RESULT *res, u_int32 ns)
+{
+	u_int32 *buf;
+
+	res->ops++;
+
+	if (res->samples == res->alloc) {
+		if (res->alloc == SAMPLES_MAX || res->fixed)
+			return(0);
+
+		res->alloc = res->alloc ? res->alloc * 2 : 65536;
+		if ((buf = realloc(res->sample, res->alloc * sizeof(u_int32))) == NULL)
+			return(-1);
+		res->sample = buf;
+	}
+
+	res->sample[res->samples++] = ns;
+	return(0);
+}
+
+/********************************** Merge ***********************************
+ *
+ *  Description: Add results of another thread
+ *
+ *               Calls and samples are summed, the duration is the
+ *               longest of both.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: res	results
+ *               add    results to add
+ *  Output.....: -
+ *  Globals....: -
+ ****************************************************************************/
+static void Merge(BENCH_RESULT *res, BENCH_RESULT *add)
+{
+	u_int32 n, ops = res->ops + add->ops;
+
+	for (n=0; n<add->samples; n++)
+		if (AddSample(res, add->sample[n]) < 0)
+			break;
+
+	res->ops = ops;
+	if (add->totalNs > res->totalNs)
+		res->totalNs = add->totalNs;
+}
+
+/********************************** Report **********************************
+ *
+ *  Description: Print results of one test
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: res	results
+ *               device device name
+ *  Output.....: -
+ *  Globals....: G_csv, G_threads
+ ****************************************************************************/
+static void Report(BENCH_RESULT *res, char *device)
+{
+	double secs = (double)res->totalNs / 1e9;
+	double opsPerSec = secs > 0 ? res->ops / secs : 0;
+
+	qsort(res->sample, res->samples, sizeof(u_int32), CmpU32);
+
+	if (G_csv)
+		printf("%s,%s,%u,%.3f,%.0f,%u,%u,%u,%u,%u,%d\n", device, res->name,
+			   (unsigned)res->ops, secs, opsPerSec,
+			   (unsigned)Percentile(res, 0),
+			   (unsigned)Percentile(res, 500),
+			   (unsigned)Percentile(res, 990),
+			   (unsigned)Percentile(res, 999),
+			   (unsigned)Percentile(res, 1000), G_threads);
+	else
+		printf("%-14s %10u %10.0f %9u %9u %9u %9u %9u\n", res->name,
+			   (unsigned)res->ops, opsPerSec,
+			   (unsigned)Percentile(res, 0),
+			   (unsigned)Percentile(res, 500),
+			   (unsigned)Percentile(res, 990),
+			   (unsigned)Percentile(res, 999),
+			   (unsigned)Percentile(res, 1000));
+}
+
+/******************************** Percentile ********************************
+ *
+ *  Description: Get percentile of sorted samples (nearest rank)
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: res		results (samples sorted)
+ *               permill    percentile [1/1000] (0=min, 1000=max)
+ *  Output.....: return     latency [ns]
+ *  Globals....: -
+ ****************************************************************************/
+static u_int32 Percentile(BENCH_RESULT *res, u_int32 permill)
+{
+	u_int64 rank;
+
+	if (res->samples == 0)
+		return(0);
+
+	rank = ((u_int64)res->samples * permill + 999) / 1000;
+
+	return(res->sample[rank ? rank - 1 : 0]);
+}
+
+static int CmpU32(const void *a, const void *b)
+{
+	u_int32 x = *(const u_int32*)a;
+	u_int32 y = *(const u_int32*)b;
+
+	return((x > y) - (x < y));
+}
+
+/********************************** TimeNs **********************************
+ *
+ *  Description: Get monotonic time [ns]
+ *
+ *               Without CLOCK_MONOTONIC, the ms timer of usr_oss is used.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: -
+ *  Output.....: return     time [ns]
+ *  Globals....: -
+ ****************************************************************************/
+static u_int64 TimeNs(void)
+{
+#ifdef LINUX
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return( (u_int64)ts.tv_sec * 1000000000 + ts.tv_nsec );
+#else
+	return( (u_int64)UOS_MsecTimerGet() * 1000000 );
+#endif
+}
+
+/********************************* PrintError ********************************
+ *
+ *  Description: Print MDIS error message
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: info	info string
+ *  Output.....: -
+ *  Globals....: -
+ ****************************************************************************/
+static void PrintError(char *info)
+{
+	printf("*** can't %s: %s\n", info, M_errstring(UOS_ErrnoGet()));
+}
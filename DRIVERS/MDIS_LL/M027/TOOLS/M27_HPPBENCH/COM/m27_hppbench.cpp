@@ -0,0 +1,239 @@
+/****************************************************************************
+ ************                                                    ************
+ ************              M 2 7 _ H P P B E N C H               ************
+ ************                                                    ************
+ ****************************************************************************
+ *
+ *  Description: Compare the C++ wrapper (m27.hpp) with the raw C API
+ *
+ *               Each operation is run with the raw MDIS calls and with
+ *               the m27::Path method that maps onto the same call.
+ *               Both variants run in alternating rounds (ABBA order),
+ *               so drifts of the machine affect them equally. Reported
+ *               is the best round of each variant in ns/call and the
+ *               difference.
+ *
+ *               Operations:
+ *                 set     M_setstat(M27_SET_MASK/M27_CLR_MASK)
+ *                 masked  M_setstat(M27_WRITE_MASKED)
+ *                 read    M_getstat(M27_BLK_CMDLIST, read command)
+ *
+ *     Required: libraries: mdis_api, usr_oss
+ *     Switches: LINUX		use CLOCK_MONOTONIC (ns) for time measurement,
+ *                          otherwise the ms timer of usr_oss is used
+ *
+ *---------------------------------------------------------------------------
+ * Copyright 2026, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <type_traits>
+#ifdef LINUX
+#	include <time.h>
+#endif
+#include <MEN/men_typs.h>
+#include <MEN/usr_oss.h>
+#include <MEN/mdis_api.h>
+#include <MEN/m27.hpp>
+
+/*--------------------------------------+
+|   DEFINES                             |
++--------------------------------------*/
+#define ROUNDS		10			/* rounds per variant */
+#define ITER_DEF	100000		/* default calls per round */
+
+/* the wrapper types cost nothing */
+static_assert(sizeof(m27::Mask) == sizeof(u_int16), "Mask size");
+static_assert(sizeof(m27::Path) == sizeof(MDIS_PATH), "Path size");
+static_assert(!std::is_copy_constructible<m27::Path>::value, "Path copy");
+static_assert(std::is_nothrow_move_constructible<m27::Path>::value,
+			  "Path move");
+static_assert(m27::Mask(m27::Channel(15)).bits() == 0x8000, "Channel");
+
+/*--------------------------------------+
+|   PROTOTYPES                          |
++--------------------------------------*/
+static u_int64 TimeNs(void);
+static int RawOp(MDIS_PATH path, int op, u_int32 iter);
+static void HppOp(m27::Path &path, int op, u_int32 iter);
+
+static const char *G_opName[] = { "set", "masked", "read" };
+
+/********************************* main *************************************
+ *
+ *  Description: Program main function
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: argc,argv	argument counter, data ..
+ *  Output.....: return	    success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+int main(int argc, char *argv[])
+{
+	u_int64 t, raw, hpp;
+	u_int32 iter;
+	int op, r;
+
+	if (argc < 2 || strcmp(argv[1], "-?") == 0) {
+		printf("Syntax:   m27_hppbench <device> [<iterations>]\n");
+		printf("Function: Compare C++ wrapper and raw C API calls\n");
+		printf("          (best of %d rounds, default %d calls)\n",
+			   ROUNDS, ITER_DEF);
+		return(1);
+	}
+
+	iter = (argc > 2) ? (u_int32)atoi(argv[2]) : ITER_DEF;
+	if (iter == 0)
+		iter = 1;
+
+	try {
+		m27::Path path(argv[1]);
+
+		printf("op        raw [ns]   c++ [ns]   diff\n");
+
+		for (op=0; op<3; op++) {
+			raw = hpp = (u_int64)-1;
+
+			for (r=0; r<2*ROUNDS; r++) {
+				/* alternate the variant that runs first */
+				t = TimeNs();
+				if ((r ^ (r >> 1)) & 1)
+					HppOp(path, op, iter);
+				else if (RawOp(path.native_handle(), op, iter))
+					throw m27::Error(G_opName[op], UOS_ErrnoGet());
+				t = TimeNs() - t;
+
+				if ((r ^ (r >> 1)) & 1) {
+					if (t < hpp)
+						hpp = t;
+				}
+				else if (t < raw)
+					raw = t;
+			}
+
+			printf("%-8s %9.1f  %9.1f  %+5.1f%%\n", G_opName[op],
+				   (double)raw / iter, (double)hpp / iter,
+				   raw ? ((double)hpp - (double)raw) * 100.0 / raw : 0.0);
+		}
+
+		path.clear(m27::Mask::all());
+	}
+	catch (const std::exception &e) {
+		printf("*** %s\n", e.what());
+		return(1);
+	}
+
+	return(0);
+}
+
+/********************************** RawOp ***********************************
+ *
+ *  Description: Run operation with the raw C API
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: path	device path
+ *               op		operation (index of G_opName)
+ *               iter	nr of calls
+ *  Output.....: return	0 | -1 (error)
+ *  Globals....: -
+ ****************************************************************************/
+static int RawOp(MDIS_PATH path, int op, u_int32 iter)
+{
+	M27_CMD cmd;
+	M_SG_BLOCK blk;
+	u_int32 n;
+
+	for (n=0; n<iter; n++) {
+		switch (op) {
+			case 0:
+				if (M_setstat(path, (n & 1) ? M27_CLR_MASK : M27_SET_MASK,
+							  0x0001) < 0)
+					return(-1);
+				break;
+			case 1:
+				if (M_setstat(path, M27_WRITE_MASKED,
+							  M27_MASKED(0x00ff, n)) < 0)
+					return(-1);
+				break;
+			default:
+				memset(&cmd, 0, sizeof(cmd));
+				cmd.op = M27_CMD_READ;
+				blk.data = &cmd;
+				blk.size = sizeof(cmd);
+				if (M_getstat(path, M27_BLK_CMDLIST, (int32*)&blk) < 0)
+					return(-1);
+		}
+	}
+	return(0);
+}
+
+/********************************** HppOp ***********************************
+ *
+ *  Description: Run operation with the C++ wrapper
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: path	device path
+ *               op		operation (index of G_opName)
+ *               iter	nr of calls
+ *  Output.....: -      (throws m27::Error)
+ *  Globals....: -
+ ****************************************************************************/
+static void HppOp(m27::Path &path, int op, u_int32 iter)
+{
+	const m27::Channel ch0(0);
+	volatile bool state;
+	u_int32 n;
+
+	for (n=0; n<iter; n++) {
+		switch (op) {
+			case 0:
+				path.write(ch0, !(n & 1));
+				break;
+			case 1:
+				path.write(m27::Mask(0x00ff), m27::Mask((u_int16)n));
+				break;
+			default:
+				state = path.read(ch0);
+				(void)state;
+		}
+	}
+}
+
+/********************************** TimeNs **********************************
+ *
+ *  Description: Get monotonic time [ns]
+ *
+ *               Without CLOCK_MONOTONIC, the ms timer of usr_oss is used.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: -
+ *  Output.....: return     time [ns]
+ *  Globals....: -
+ ****************************************************************************/
+static u_int64 TimeNs(void)
+{
+#ifdef LINUX
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return( (u_int64)ts.tv_sec * 1000000000 + ts.tv_nsec );
+#else
+	return( (u_int64)UOS_MsecTimerGet() * 1000000 );
+#endif
+}
@@ -0,0 +1,384 @@
+/****************************************************************************
+ ************                                                    ************
+ ************                   M 2 7 _ M O N                    ************
+ ************                                                    ************
+ ****************************************************************************
+ *
+ *  Description: Publish M27 output states in shared memory
+ *
+ *               One thread per device blocks in M27_BLK_WAIT_CHANGE and
+ *               publishes output word, driver generation, change count
+ *               and timestamp into the device slot of a POSIX shared
+ *               memory segment (layout and sequence lock see m27_mon.h).
+ *               Without changes, the slot is refreshed every <alive> ms
+ *               (aliveNs), so readers can detect a dead monitor.
+ *
+ *               Local readers use the M27MON library instead of opening
+ *               the devices themselves. The monitor runs in the
+ *               foreground until SIGINT/SIGTERM, then marks all slots
+ *               M27MON_STATE_STOPPED and removes the segment name.
+ *
+ *               If m27_mon may be the first or last user of a device,
+ *               set the descriptor keys OUTPUT_INIT=1 and OUTPUT_EXIT=1,
+ *               so opening and closing its path keeps the outputs.
+ *
+ *     Required: libraries: mdis_api, usr_oss, usr_utl
+ *     Switches: - (POSIX shared memory and threads required)
+ *
+ *---------------------------------------------------------------------------
+ * Copyright 2026, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <time.h>
+#include <signal.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <MEN/men_typs.h>
+#include <MEN/usr_oss.h>
+#include <MEN/usr_utl.h>
+#include <MEN/mdis_api.h>
+#include <MEN/mdis_err.h>
+#include <MEN/m27_drv.h>
+#include <MEN/m27_mon.h>
+
+static const char IdentString[]=MENT_XSTR(MAK_REVISION);
+
+/*--------------------------------------+
+|   DEFINES                             |
++--------------------------------------*/
+#define ALIVE_DEF		1000		/* default refresh interval [ms] */
+
+/*--------------------------------------+
+|   TYPEDEFS                            |
++--------------------------------------*/
+typedef struct {
+	char		*device;		/* device name */
+	M27MON_DEV	*slot;			/* slot in shared memory */
+	pthread_t	tid;			/* monitor thread */
+} MON_DEV;
+
+/*--------------------------------------+
+|   GLOBALS                             |
++--------------------------------------*/
+static M27MON_SHM	*G_shm;				/* shared memory */
+static MON_DEV		G_dev[M27MON_MAX_DEV];
+static u_int32		G_aliveMs;			/* refresh interval [ms] */
+static volatile int	G_stop;				/* terminate threads */
+
+/*--------------------------------------+
+|   PROTOTYPES                          |
++--------------------------------------*/
+static void usage(void);
+static void *Monitor(void *arg);
+static void Publish(M27MON_DEV *slot, u_int16 state, u_int16 word,
+					u_int32 gen, u_int32 changes, u_int64 timeNs);
+static u_int64 TimeNs(void);
+
+/********************************* usage ************************************
+ *
+ *  Description: Print program usage
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: -
+ *  Output.....: -
+ *  Globals....: -
+ ****************************************************************************/
+static void usage(void)
+{
+	printf("Usage:    m27_mon [<opts>] <device> [<device>..]\n");
+	printf("Function: Publish M27 output states in shared memory\n");
+	printf("Options:\n");
+	printf("  device         device name(s) (max. %d)                [none]\n",
+		   M27MON_MAX_DEV);
+	printf("  -n=<name>      shared memory name                      [%s]\n",
+		   M27MON_SHM_DEF);
+	printf("  -a=<ms>        refresh interval without changes        [%d]\n",
+		   ALIVE_DEF);
+	printf("  -k             keep shared memory name at exit         [no]\n");
+	printf("\n");
+	printf("Copyright 2026, MEN Mikro Elektronik GmbH\n%s\n", IdentString);
+}
+
+/********************************* main *************************************
+ *
+ *  Description: Program main function
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: argc,argv	argument counter, data ..
+ *  Output.....: return	    success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+int main(int argc, char *argv[])
+{
+	char *str, *errstr, *shmName, buf[40];
+	int32 n, devNbr = 0, started, keep, ret = 0;
+	sigset_t sigs;
+	int fd, sig, err;
+
+	/*--------------------+
+    |  check arguments    |
+    +--------------------*/
+	if ((errstr = UTL_ILLIOPT("n=a=k?", buf))) {	/* check args */
+		printf("*** %s\n", errstr);
+		return(1);
+	}
+
+	if (UTL_TSTOPT("?")) {						/* help requested ? */
+		usage();
+		return(1);
+	}
+
+	/*--------------------+
+    |  get arguments      |
+    +--------------------*/
+	for (n=1; n<argc; n++) {
+		if (*argv[n] == '-')
+			continue;
+		if (devNbr == M27MON_MAX_DEV ||
+			strlen(argv[n]) >= M27MON_NAME_LEN) {
+			usage();
+			return(1);
+		}
+		G_dev[devNbr++].device = argv[n];
+	}
+
+	if (devNbr == 0) {
+		usage();
+		return(1);
+	}
+
+	shmName   = ((str = UTL_TSTOPT("n=")) ? str : M27MON_SHM_DEF);
+	G_aliveMs = ((str = UTL_TSTOPT("a=")) ? atoi(str) : ALIVE_DEF);
+	keep      = (UTL_TSTOPT("k") ? 1 : 0);
+	if (G_aliveMs == 0)
+		G_aliveMs = 1;
+
+	/*--------------------+
+    |  shared memory      |
+    +--------------------*/
+	if ((fd = shm_open(shmName, O_CREAT | O_RDWR, 0644)) < 0) {
+		printf("*** can't create %s: %s\n", shmName, strerror(errno));
+		return(1);
+	}
+
+	if (ftruncate(fd, sizeof(M27MON_SHM)) < 0 ||
+		(G_shm = (M27MON_SHM*)mmap(NULL, sizeof(M27MON_SHM),
+								   PROT_READ | PROT_WRITE, MAP_SHARED,
+								   fd, 0)) == (M27MON_SHM*)MAP_FAILED) {
+		printf("*** can't map %s: %s\n", shmName, strerror(errno));
+		close(fd);
+		shm_unlink(shmName);
+		return(1);
+	}
+	close(fd);
+
+	/* invalidate for readers of a previous instance, then set up */
+	__atomic_store_n(&G_shm->magic, 0, __ATOMIC_RELEASE);
+	memset((u_int8*)G_shm + sizeof(u_int32), 0,
+		   sizeof(M27MON_SHM) - sizeof(u_int32));
+
+	G_shm->version = M27MON_VERSION;
+	G_shm->devNbr  = devNbr;
+	G_shm->pid     = (u_int32)getpid();
+	G_shm->aliveMs = G_aliveMs;
+	for (n=0; n<devNbr; n++) {
+		G_dev[n].slot = &G_shm->dev[n];
+		strncpy(G_dev[n].slot->name, G_dev[n].device, M27MON_NAME_LEN - 1);
+	}
+
+	__atomic_store_n(&G_shm->magic, M27MON_MAGIC, __ATOMIC_RELEASE);
+
+	/*--------------------+
+    |  run monitors       |
+    +--------------------*/
+	/* signals are taken by main only */
+	sigemptyset(&sigs);
+	sigaddset(&sigs, SIGINT);
+	sigaddset(&sigs, SIGTERM);
+	pthread_sigmask(SIG_BLOCK, &sigs, NULL);
+
+	for (started=0; started<devNbr; started++) {
+		if ((err = pthread_create(&G_dev[started].tid, NULL, Monitor,
+								  &G_dev[started]))) {
+			printf("*** can't create monitor thread: %s\n", strerror(err));
+			ret = 1;
+			break;
+		}
+	}
+
+	if (!ret) {
+		printf("m27_mon: %d device(s) in %s\n", (int)devNbr, shmName);
+		fflush(stdout);
+
+		sigwait(&sigs, &sig);
+	}
+
+	/*--------------------+
+    |  cleanup            |
+    +--------------------*/
+	G_stop = 1;
+	for (n=0; n<started; n++)
+		pthread_join(G_dev[n].tid, NULL);
+
+	if (!keep || ret)
+		shm_unlink(shmName);
+	munmap(G_shm, sizeof(M27MON_SHM));
+
+	return(ret);
+}
+
+/********************************* Monitor **********************************
+ *
+ *  Description: Monitor one device (thread)
+ *
+ *               The first wait passes a generation different from the
+ *               current one and returns immediately with the state.
+ *               Errors are published and the device is reopened after
+ *               the refresh interval.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: arg		MON_DEV
+ *  Output.....: return     NULL
+ *  Globals....: G_stop, G_aliveMs
+ ****************************************************************************/
+static void *Monitor(void *arg)
+{
+	MON_DEV *md = (MON_DEV*)arg;
+	M27MON_DEV *slot = md->slot;
+	M27_WAIT_CHANGE wc;
+	M_SG_BLOCK blk;
+	MDIS_PATH path = -1;
+	u_int32 gen = 0, changes = 0;
+	u_int64 timeNs = 0;
+	u_int16 word = 0;
+	int32 gen0, valid = 0;
+
+	blk.data = &wc;
+
+	while (!G_stop) {
+		/* (re)open */
+		if (path < 0) {
+			if ((path = M_open(md->device)) < 0 ||
+				M_getstat(path, M27_GENERATION, &gen0) < 0) {
+				printf("*** %s: %s\n", md->device,
+					   M_errstring(UOS_ErrnoGet()));
+				Publish(slot, M27MON_STATE_ERROR, word, gen, changes,
+						timeNs);
+				if (path >= 0)
+					M_close(path);
+				path = -1;
+				UOS_Delay(G_aliveMs);
+				continue;
+			}
+			wc.gen = (u_int32)gen0 - 1;
+			valid  = 0;
+		}
+		else
+			wc.gen = gen;
+
+		wc.timeout  = (int32)G_aliveMs;
+		wc.reserved = 0;
+		blk.size    = sizeof(wc);
+
+		if (M_getstat(path, M27_BLK_WAIT_CHANGE, (int32*)&blk) < 0) {
+			if (UOS_ErrnoGet() == ERR_OSS_TIMEOUT) {
+				/* no change: refresh aliveNs */
+				Publish(slot, M27MON_STATE_OK, word, gen, changes, timeNs);
+				continue;
+			}
+
+			printf("*** %s: %s\n", md->device, M_errstring(UOS_ErrnoGet()));
+			Publish(slot, M27MON_STATE_ERROR, word, gen, changes, timeNs);
+			M_close(path);
+			path = -1;
+			UOS_Delay(G_aliveMs);
+			continue;
+		}
+
+		/* all changes since the last wait count */
+		if (valid)
+			changes += wc.gen - gen;
+		valid  = 1;
+		gen    = wc.gen;
+		word   = wc.word;
+		timeNs = TimeNs();
+		Publish(slot, M27MON_STATE_OK, word, gen, changes, timeNs);
+	}
+
+	if (path >= 0)
+		M_close(path);
+
+	Publish(slot, M27MON_STATE_STOPPED, word, gen, changes, timeNs);
+	return(NULL);
+}
+
+/********************************* Publish **********************************
+ *
+ *  Description: Update device slot under the sequence lock
+ *
+ *               Only the thread of the device writes the slot.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: slot		device slot
+ *               state      M27MON_STATE_xxx
+ *               word       output word
+ *               gen        driver generation
+ *               changes    changes seen
+ *               timeNs     time of last change [ns]
+ *  Output.....: -
+ *  Globals....: -
+ ****************************************************************************/
+static void Publish(M27MON_DEV *slot, u_int16 state, u_int16 word,
+					u_int32 gen, u_int32 changes, u_int64 timeNs)
+{
+	u_int32 seq = slot->seq;
+
+	__atomic_store_n(&slot->seq, seq + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	slot->word    = word;
+	slot->state   = state;
+	slot->gen     = gen;
+	slot->changes = changes;
+	slot->timeNs  = timeNs;
+	slot->aliveNs = TimeNs();
+
+	__atomic_store_n(&slot->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+/********************************** TimeNs **********************************
+ *
+ *  Description: Get monotonic time [ns]
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: -
+ *  Output.....: return     time [ns]
+ *  Globals....: -
+ ****************************************************************************/
+static u_int64 TimeNs(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return( (u_int64)ts.tv_sec * 1000000000 + ts.tv_nsec );
+}
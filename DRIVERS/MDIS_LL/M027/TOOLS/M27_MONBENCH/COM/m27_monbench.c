@@ -0,0 +1,385 @@
+/****************************************************************************
+ ************                                                    ************
+ ************              M 2 7 _ M O N B E N C H               ************
+ ************                                                    ************
+ ****************************************************************************
+ *
+ *  Description: Concurrent reader benchmark for the M27 state monitor
+ *
+ *               <n> reader threads (default 64) read all device slots of
+ *               the m27_mon segment round robin with M27MON_Read for
+ *               the given time. Reported are the reads per second, the
+ *               time per read and the sequence lock retries.
+ *
+ *               With -s, no m27_mon is needed: the benchmark creates an
+ *               own segment and a writer thread updates its slots at
+ *               the given rate with values derived from one counter.
+ *               The readers check every snapshot for consistency, so a
+ *               torn read is detected.
+ *
+ *     Required: libraries: m27_mon, mdis_api, usr_oss, usr_utl
+ *     Switches: - (POSIX shared memory and threads required)
+ *
+ *---------------------------------------------------------------------------
+ * Copyright 2026, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <MEN/men_typs.h>
+#include <MEN/usr_oss.h>
+#include <MEN/usr_utl.h>
+#include <MEN/mdis_api.h>
+#include <MEN/m27_mon.h>
+
+static const char IdentString[]=MENT_XSTR(MAK_REVISION);
+
+/*--------------------------------------+
+|   DEFINES                             |
++--------------------------------------*/
+#define READERS_DEF		64			/* default nr of readers */
+#define READERS_MAX		256			/* max. nr of readers */
+#define SECS_DEF		5			/* default duration [s] */
+#define RATE_DEF		10000		/* default self test updates/s */
+#define SELF_DEV		4			/* self test: nr of slots */
+#define READ_BATCH		1024		/* reads between time checks */
+
+/*--------------------------------------+
+|   TYPEDEFS                            |
++--------------------------------------*/
+typedef struct {
+	pthread_t	tid;
+	u_int64		reads;			/* successful reads */
+	u_int64		retries;		/* sequence lock retries */
+	u_int64		torn;			/* inconsistent snapshots (self test) */
+	u_int64		errors;			/* failed reads */
+	u_int64		ns;				/* time spent [ns] */
+} READER;
+
+/*--------------------------------------+
+|   GLOBALS                             |
++--------------------------------------*/
+static M27MON_HANDLE	*G_mon;
+static M27MON_SHM		*G_shm;			/* self test segment */
+static u_int64			G_endNs;		/* end of test [ns] */
+static u_int32			G_rate;			/* self test updates/s */
+static int				G_self;			/* self test */
+static u_int64			G_updates;		/* self test: slot updates */
+
+/*--------------------------------------+
+|   PROTOTYPES                          |
++--------------------------------------*/
+static void usage(void);
+static void *Reader(void *arg);
+static void *Writer(void *arg);
+static u_int64 TimeNs(void);
+
+/********************************* usage ************************************
+ *
+ *  Description: Print program usage
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: -
+ *  Output.....: -
+ *  Globals....: -
+ ****************************************************************************/
+static void usage(void)
+{
+	printf("Usage:    m27_monbench [<opts>]\n");
+	printf("Function: Concurrent reader benchmark for the M27 state monitor\n");
+	printf("Options:\n");
+	printf("  -n=<name>      shared memory name                      [%s]\n",
+		   M27MON_SHM_DEF);
+	printf("  -p=<n>         nr of reader threads (1..%d)           [%d]\n",
+		   READERS_MAX, READERS_DEF);
+	printf("  -T=<sec>       test duration                           [%d]\n",
+		   SECS_DEF);
+	printf("  -s             self test with own segment and writer   [no]\n");
+	printf("  -r=<n>         self test: slot updates per second      [%d]\n",
+		   RATE_DEF);
+	printf("\n");
+	printf("Copyright 2026, MEN Mikro Elektronik GmbH\n%s\n", IdentString);
+}
+
+/********************************* main *************************************
+ *
+ *  Description: Program main function
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: argc,argv	argument counter, data ..
+ *  Output.....: return	    success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+int main(int argc, char *argv[])
+{
+	static READER rd[READERS_MAX];
+	char *str, *errstr, *shmName, buf[40], selfName[40];
+	int32 n, readers, secs, ret = 0;
+	u_int64 reads = 0, retries = 0, torn = 0, errors = 0, ns = 0;
+	u_int64 minReads = (u_int64)-1, maxReads = 0;
+	pthread_t wtid;
+	int fd, err = 0, writer = 0, started;
+
+	/*--------------------+
+    |  check arguments    |
+    +--------------------*/
+	if ((errstr = UTL_ILLIOPT("n=p=T=sr=?", buf))) {	/* check args */
+		printf("*** %s\n", errstr);
+		return(1);
+	}
+
+	if (UTL_TSTOPT("?")) {						/* help requested ? */
+		usage();
+		return(1);
+	}
+
+	shmName = ((str = UTL_TSTOPT("n=")) ? str : M27MON_SHM_DEF);
+	readers = ((str = UTL_TSTOPT("p=")) ? atoi(str) : READERS_DEF);
+	secs    = ((str = UTL_TSTOPT("T=")) ? atoi(str) : SECS_DEF);
+	G_rate  = ((str = UTL_TSTOPT("r=")) ? atoi(str) : RATE_DEF);
+	G_self  = (UTL_TSTOPT("s") ? 1 : 0);
+
+	if (readers < 1 || readers > READERS_MAX || secs < 1 || G_rate == 0) {
+		usage();
+		return(1);
+	}
+
+	/*--------------------+
+    |  self test segment  |
+    +--------------------*/
+	if (G_self) {
+		sprintf(selfName, "/m27_monbench.%d", (int)getpid());
+		shmName = selfName;
+
+		if ((fd = shm_open(shmName, O_CREAT | O_EXCL | O_RDWR, 0600)) < 0 ||
+			ftruncate(fd, sizeof(M27MON_SHM)) < 0 ||
+			(G_shm = (M27MON_SHM*)mmap(NULL, sizeof(M27MON_SHM),
+									   PROT_READ | PROT_WRITE, MAP_SHARED,
+									   fd, 0)) == (M27MON_SHM*)MAP_FAILED) {
+			printf("*** can't create %s: %s\n", shmName, strerror(errno));
+			if (fd >= 0) {
+				close(fd);
+				shm_unlink(shmName);
+			}
+			return(1);
+		}
+		close(fd);
+
+		G_shm->version = M27MON_VERSION;
+		G_shm->devNbr  = SELF_DEV;
+		for (n=0; n<SELF_DEV; n++)
+			sprintf(G_shm->dev[n].name, "self_%d", (int)n);
+		__atomic_store_n(&G_shm->magic, M27MON_MAGIC, __ATOMIC_RELEASE);
+	}
+
+	if (M27MON_Attach(shmName, &G_mon) < 0) {
+		printf("*** can't attach %s: %s\n", shmName,
+			   M_errstring(UOS_ErrnoGet()));
+		ret = 1;
+		goto CLEANUP;
+	}
+
+	/*--------------------+
+    |  run readers        |
+    +--------------------*/
+	G_endNs = TimeNs() + (u_int64)secs * 1000000000;
+
+	/* threads end at G_endNs: on errors, the started ones are joined */
+	if (G_self) {
+		if ((err = pthread_create(&wtid, NULL, Writer, NULL)))
+			ret = 1;
+		else
+			writer = 1;
+	}
+
+	for (started=0; !ret && started<readers; started++) {
+		if ((err = pthread_create(&rd[started].tid, NULL, Reader,
+								  &rd[started]))) {
+			ret = 1;
+			break;
+		}
+	}
+	if (ret)
+		printf("*** can't create thread: %s\n", strerror(err));
+
+	for (n=0; n<started; n++) {
+		pthread_join(rd[n].tid, NULL);
+		reads   += rd[n].reads;
+		retries += rd[n].retries;
+		torn    += rd[n].torn;
+		errors  += rd[n].errors;
+		ns      += rd[n].ns;
+		if (rd[n].reads < minReads)
+			minReads = rd[n].reads;
+		if (rd[n].reads > maxReads)
+			maxReads = rd[n].reads;
+	}
+
+	if (writer)
+		pthread_join(wtid, NULL);
+
+	if (ret)
+		goto CLEANUP;
+
+	/*--------------------+
+    |  report             |
+    +--------------------*/
+	printf("readers      : %d on %d device slot(s)%s\n", (int)readers,
+		   (int)M27MON_DevNbr(G_mon), G_self ? " (self test)" : "");
+	printf("reads        : %llu (%.0f/s, per reader %llu..%llu)\n",
+		   (unsigned long long)reads, (double)reads / secs,
+		   (unsigned long long)minReads, (unsigned long long)maxReads);
+	printf("time/read    : %.1f ns (thread time / reads)\n",
+		   reads ? (double)ns / reads : 0.0);
+	printf("retries      : %llu (%.4f%%)\n", (unsigned long long)retries,
+		   reads ? (double)retries * 100.0 / reads : 0.0);
+	printf("errors       : %llu\n", (unsigned long long)errors);
+	if (G_self) {
+		printf("updates      : %llu\n", (unsigned long long)G_updates);
+		printf("torn reads   : %llu\n", (unsigned long long)torn);
+	}
+
+	if (errors || torn)
+		ret = 1;
+
+CLEANUP:
+	M27MON_Detach(&G_mon);
+	if (G_self) {
+		munmap(G_shm, sizeof(M27MON_SHM));
+		shm_unlink(shmName);
+	}
+	return(ret);
+}
+
+/********************************** Reader **********************************
+ *
+ *  Description: Read all slots round robin until the end time (thread)
+ *
+ *               In the self test all fields of a slot derive from the
+ *               generation (see Writer), other values are torn reads.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: arg		READER
+ *  Output.....: return     NULL
+ *  Globals....: G_mon, G_endNs, G_self
+ ****************************************************************************/
+static void *Reader(void *arg)
+{
+	READER *rd = (READER*)arg;
+	M27MON_STATE st;
+	int32 devNbr = M27MON_DevNbr(G_mon), idx = 0, n;
+	u_int64 start = TimeNs(), now = start;
+
+	while (now < G_endNs) {
+		for (n=0; n<READ_BATCH; n++) {
+			if (M27MON_Read(G_mon, idx, &st) < 0)
+				rd->errors++;
+			else {
+				rd->reads++;
+				rd->retries += st.retries;
+				if (G_self &&
+					(st.word != (u_int16)st.gen || st.changes != st.gen ||
+					 st.timeNs != (u_int64)st.gen * 3 ||
+					 st.aliveNs != (u_int64)st.gen * 7))
+					rd->torn++;
+			}
+			if (++idx == devNbr)
+				idx = 0;
+		}
+		now = TimeNs();
+	}
+
+	rd->ns = now - start;
+	return(NULL);
+}
+
+/********************************** Writer **********************************
+ *
+ *  Description: Update the self test slots until the end time (thread)
+ *
+ *               Same sequence lock protocol as m27_mon. All fields of a
+ *               slot are derived from its generation counter.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: arg		-
+ *  Output.....: return     NULL
+ *  Globals....: G_shm, G_endNs, G_rate, G_updates
+ ****************************************************************************/
+static void *Writer(void *arg)
+{
+	u_int64 next = TimeNs(), interval = 1000000000ULL / G_rate;
+	struct timespec ts;
+	M27MON_DEV *slot;
+	u_int32 seq, gen;
+	int n = 0;
+
+	while (next < G_endNs) {
+		slot = &G_shm->dev[n];
+		seq  = slot->seq;
+		gen  = slot->gen + 1;
+
+		__atomic_store_n(&slot->seq, seq + 1, __ATOMIC_RELAXED);
+		__atomic_thread_fence(__ATOMIC_RELEASE);
+
+		slot->word    = (u_int16)gen;
+		slot->state   = M27MON_STATE_OK;
+		slot->gen     = gen;
+		slot->changes = gen;
+		slot->timeNs  = (u_int64)gen * 3;
+		slot->aliveNs = (u_int64)gen * 7;
+
+		__atomic_store_n(&slot->seq, seq + 2, __ATOMIC_RELEASE);
+
+		G_updates++;
+		if (++n == SELF_DEV)
+			n = 0;
+
+		/* absolute deadlines, no drift */
+		next += interval;
+		ts.tv_sec  = (time_t)(next / 1000000000);
+		ts.tv_nsec = (long)(next % 1000000000);
+		while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL)
+			   == EINTR)
+			;
+	}
+
+	return(NULL);
+}
+
+/********************************** TimeNs **********************************
+ *
+ *  Description: Get monotonic time [ns]
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: -
+ *  Output.....: return     time [ns]
+ *  Globals....: -
+ ****************************************************************************/
+static u_int64 TimeNs(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return( (u_int64)ts.tv_sec * 1000000000 + ts.tv_nsec );
+}
@@ -0,0 +1,875 @@
+/****************************************************************************
+ ************                                                    ************
+ ************                  M 2 7 _ P L A Y                   ************
+ ************                                                    ************
+ ****************************************************************************
+ *
+ *  Description: Play binary output schedules on M27 devices
+ *
+ *               Modes:
+ *                 play     m27_play <file> <device> [<device>..]
+ *                          The schedule file (format see m27_play.h) is
+ *                          mapped into memory and streamed: each record
+ *                          is applied at its absolute deadline with one
+ *                          M27_WRITE_MASKED setstat of the changed
+ *                          channels, the device settings (block mode,
+ *                          current channel) are not touched. Only the
+ *                          channels driven by the schedule are reset
+ *                          at start, all others are left as they are.
+ *                          Late records are counted.
+ *                 convert  m27_play -c [-t=<ns>] <text> <file>
+ *                          Convert a text schedule into a schedule file.
+ *                 info     m27_play -i <file>
+ *                          Check a schedule file and print its contents.
+ *
+ *               Text schedule, one transition per line:
+ *                 <time> <device> <word>
+ *                   time    [us] since start (may have decimals),
+ *                           not decreasing
+ *                   device  device index 0..15 (order of the devices
+ *                           given for play)
+ *                   word    new output word 0..0xffff (hex with 0x)
+ *               Empty lines and lines starting with '#' are ignored.
+ *
+ *     Required: libraries: mdis_api, usr_oss, usr_utl
+ *     Switches: LINUX		mmap the file, CLOCK_MONOTONIC deadlines and
+ *                          SCHED_FIFO (-R); otherwise the file is read into
+ *                          memory and the ms timer of usr_oss is used
+ *
+ *---------------------------------------------------------------------------
+ * Copyright 2026, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#ifdef LINUX
+#	include <errno.h>
+#	include <time.h>
+#	include <sched.h>
+#	include <fcntl.h>
+#	include <unistd.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#endif
+#include <MEN/men_typs.h>
+#include <MEN/usr_oss.h>
+#include <MEN/usr_utl.h>
+#include <MEN/mdis_api.h>
+#include <MEN/m27_drv.h>
+#include <MEN/m27_play.h>
+
+static const char IdentString[]=MENT_XSTR(MAK_REVISION);
+
+/*--------------------------------------+
+|   DEFINES                             |
++--------------------------------------*/
+#define TICK_DEF		1000		/* default tick of converted files [ns] */
+#define LATE_DEF		100			/* default late threshold [us] */
+#define START_DEF		10			/* default start delay [ms] */
+#define TEXT_LINE_MAX	256			/* max. text line length */
+
+/*--------------------------------------+
+|   TYPEDEFS                            |
++--------------------------------------*/
+/* mapped schedule file */
+typedef struct {
+	const u_int8	*data;		/* file contents */
+	u_int64			size;		/* file size [bytes] */
+	u_int32			devices;	/* header: nr of devices */
+	u_int32			tickNs;		/* header: tick [ns] */
+	u_int64			events;		/* header: nr of records */
+	u_int64			duration;	/* header: duration [ticks] */
+} PLAY_FILE;
+
+/*--------------------------------------+
+|   PROTOTYPES                          |
++--------------------------------------*/
+static void usage(void);
+static void PrintError(char *info);
+static int Convert(char *textName, char *fileName, u_int32 tickNs);
+static int Info(char *fileName);
+static int Play(char *fileName, char **device, int devNbr, u_int32 lateUs,
+				u_int32 startMs);
+static int MapFile(char *fileName, PLAY_FILE *pf);
+static void UnmapFile(PLAY_FILE *pf);
+static int Decode(const u_int8 **pp, const u_int8 *end, u_int64 *delta,
+				  int *dev, u_int16 *xorWord);
+static int PutVarint(FILE *fp, u_int64 val);
+static void PutLe(u_int8 *p, u_int64 val, int size);
+static u_int64 GetLe(const u_int8 *p, int size);
+static void SleepUntil(u_int64 ns);
+static u_int64 TimeNs(void);
+
+/********************************* usage ************************************
+ *
+ *  Description: Print program usage
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: -
+ *  Output.....: -
+ *  Globals....: -
+ ****************************************************************************/
+static void usage(void)
+{
+	printf("Usage:    m27_play [<opts>] <file> <device> [<device>..]\n");
+	printf("          m27_play -c [-t=<ns>] <text> <file>\n");
+	printf("          m27_play -i <file>\n");
+	printf("Function: Play binary output schedules on M27 devices\n");
+	printf("Options:\n");
+	printf("  file           schedule file                           [none]\n");
+	printf("  device         device for device index 0, 1..          [none]\n");
+	printf("  -l=<us>        count records later than <us> as late   [%d]\n",
+		   LATE_DEF);
+	printf("  -s=<ms>        start delay                             [%d]\n",
+		   START_DEF);
+#ifdef LINUX
+	printf("  -R=<prio>      run with SCHED_FIFO <prio>              [no]\n");
+#endif
+	printf("  -c             convert text schedule <text> to <file>\n");
+	printf("  -t=<ns>        tick of the converted file              [%d]\n",
+		   TICK_DEF);
+	printf("  -i             check <file> and print its contents\n");
+	printf("Text schedule: one '<time[us]> <device> <word>' per line\n");
+	printf("\n");
+	printf("Copyright 2026, MEN Mikro Elektronik GmbH\n%s\n", IdentString);
+}
+
+/********************************* main *************************************
+ *
+ *  Description: Program main function
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: argc,argv	argument counter, data ..
+ *  Output.....: return	    success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+int main(int argc, char *argv[])
+{
+	char *arg[2 + M27_PLAY_DEV_MAX];
+	char *str, *errstr, buf[40];
+	int32 n, args;
+	u_int32 tickNs, lateUs, startMs;
+#ifdef LINUX
+	struct sched_param sp;
+#endif
+
+	/*--------------------+
+    |  check arguments    |
+    +--------------------*/
+	if ((errstr = UTL_ILLIOPT("l=s=R=ct=i?", buf))) {	/* check args */
+		printf("*** %s\n", errstr);
+		return(1);
+	}
+
+	if (UTL_TSTOPT("?")) {						/* help requested ? */
+		usage();
+		return(1);
+	}
+
+	/*--------------------+
+    |  get arguments      |
+    +--------------------*/
+	for (args=0, n=1; n<argc; n++) {
+		if (*argv[n] == '-')
+			continue;
+		if (args == 2 + M27_PLAY_DEV_MAX) {
+			printf("*** max. %d devices\n", M27_PLAY_DEV_MAX);
+			return(1);
+		}
+		arg[args++] = argv[n];
+	}
+
+	tickNs  = ((str = UTL_TSTOPT("t=")) ? atoi(str) : TICK_DEF);
+	lateUs  = ((str = UTL_TSTOPT("l=")) ? atoi(str) : LATE_DEF);
+	startMs = ((str = UTL_TSTOPT("s=")) ? atoi(str) : START_DEF);
+
+	if (UTL_TSTOPT("c")) {
+		if (args != 2 || tickNs == 0) {
+			usage();
+			return(1);
+		}
+		return(Convert(arg[0], arg[1], tickNs));
+	}
+
+	if (UTL_TSTOPT("i")) {
+		if (args != 1) {
+			usage();
+			return(1);
+		}
+		return(Info(arg[0]));
+	}
+
+	if (args < 2) {
+		usage();
+		return(1);
+	}
+
+#ifdef LINUX
+	if ((str = UTL_TSTOPT("R="))) {
+		sp.sched_priority = atoi(str);
+		if (sched_setscheduler(0, SCHED_FIFO, &sp) < 0)
+			printf("*** SCHED_FIFO: %s\n", strerror(errno));
+	}
+#endif
+
+	return(Play(arg[0], &arg[1], args - 1, lateUs, startMs));
+}
+
+/********************************* Convert **********************************
+ *
+ *  Description: Convert text schedule into schedule file
+ *
+ *               Lines that do not change the word of their device are
+ *               dropped.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: textName	text schedule
+ *               fileName	schedule file to create
+ *               tickNs		tick [ns]
+ *  Output.....: return	    0 | 1 (error)
+ *  Globals....: -
+ ****************************************************************************/
+static int Convert(char *textName, char *fileName, u_int32 tickNs)
+{
+	FILE *in, *out;
+	char line[TEXT_LINE_MAX], *p, *end;
+	u_int8 hdr[M27_PLAY_HDR_SIZE], rec[3];
+	u_int16 word[M27_PLAY_DEV_MAX], xorWord, val;
+	u_int64 tick, last = 0, events = 0;
+	double us;
+	unsigned long word32;
+	u_int32 devices = 1;
+	int dev, ch, lineNr = 0, ret = 1;
+
+	memset(word, 0, sizeof(word));
+	memset(hdr, 0, sizeof(hdr));
+
+	if (!(in = fopen(textName, "r"))) {
+		printf("*** can't open %s\n", textName);
+		return(1);
+	}
+
+	if (!(out = fopen(fileName, "wb"))) {
+		printf("*** can't create %s\n", fileName);
+		goto CLEANUP_IN;
+	}
+
+	/* header is written at the end */
+	if (fwrite(hdr, sizeof(hdr), 1, out) != 1)
+		goto WR_ERROR;
+
+	while (fgets(line, sizeof(line), in)) {
+		lineNr++;
+		for (p=line; *p == ' ' || *p == '\t'; p++)
+			;
+		if (*p == '#' || *p == '\n' || *p == '\r' || *p == '\0')
+			continue;
+
+		/* <time> <device> <word> */
+		us = strtod(p, &end);
+		if (end == p || us < 0)
+			goto SYNTAX;
+		p = end;
+		dev = (int)strtol(p, &end, 0);
+		if (end == p || dev < 0 || dev >= M27_PLAY_DEV_MAX)
+			goto SYNTAX;
+		p = end;
+		word32 = strtoul(p, &end, 0);
+		if (end == p)
+			goto SYNTAX;
+		if (word32 > 0xffff) {
+			printf("*** line %d: word 0x%lx exceeds 0xffff\n",
+				   lineNr, word32);
+			goto CLEANUP;
+		}
+		val = (u_int16)word32;
+
+		tick = (u_int64)(us * 1000.0 / tickNs + 0.5);
+		if (tick < last) {
+			printf("*** line %d: time decreases\n", lineNr);
+			goto CLEANUP;
+		}
+
+		if ((xorWord = (u_int16)(val ^ word[dev])) == 0)
+			continue;
+
+		/* single channel record if one bit changes */
+		for (ch=0; ch<M27_PLAY_CH_NUMBER; ch++)
+			if (xorWord == (1 << ch))
+				break;
+
+		if (PutVarint(out, ((tick - last) << 1) |
+					  (ch < M27_PLAY_CH_NUMBER ? M27_PLAY_SINGLE : 0)))
+			goto WR_ERROR;
+
+		if (ch < M27_PLAY_CH_NUMBER) {
+			rec[0] = (u_int8)((dev << 4) | ch);
+			if (fwrite(rec, 1, 1, out) != 1)
+				goto WR_ERROR;
+		}
+		else {
+			rec[0] = (u_int8)dev;
+			PutLe(&rec[1], xorWord, 2);
+			if (fwrite(rec, 3, 1, out) != 1)
+				goto WR_ERROR;
+		}
+
+		word[dev] = val;
+		last = tick;
+		events++;
+		if ((u_int32)dev >= devices)
+			devices = dev + 1;
+	}
+
+	PutLe(&hdr[M27_PLAY_OFF_MAGIC],  M27_PLAY_MAGIC, 4);
+	PutLe(&hdr[M27_PLAY_OFF_VER],    M27_PLAY_VERSION, 2);
+	PutLe(&hdr[M27_PLAY_OFF_DEV],    devices, 2);
+	PutLe(&hdr[M27_PLAY_OFF_TICK],   tickNs, 4);
+	PutLe(&hdr[M27_PLAY_OFF_EVENTS], events, 8);
+	PutLe(&hdr[M27_PLAY_OFF_DUR],    last, 8);
+
+	if (fseek(out, 0, SEEK_SET) || fwrite(hdr, sizeof(hdr), 1, out) != 1)
+		goto WR_ERROR;
+
+	printf("%llu records, %u device(s), %llu ticks of %u ns\n",
+		   (unsigned long long)events, devices, (unsigned long long)last,
+		   tickNs);
+	ret = 0;
+	goto CLEANUP;
+
+SYNTAX:
+	printf("*** line %d: syntax error\n", lineNr);
+	goto CLEANUP;
+
+WR_ERROR:
+	printf("*** can't write %s\n", fileName);
+
+CLEANUP:
+	if (fclose(out) && ret == 0) {
+		printf("*** can't write %s\n", fileName);
+		ret = 1;
+	}
+CLEANUP_IN:
+	fclose(in);
+	return(ret);
+}
+
+/*********************************** Info ***********************************
+ *
+ *  Description: Check schedule file and print its contents
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: fileName	schedule file
+ *  Output.....: return	    0 | 1 (error)
+ *  Globals....: -
+ ****************************************************************************/
+static int Info(char *fileName)
+{
+	PLAY_FILE pf;
+	const u_int8 *p, *end;
+	u_int64 delta, tick = 0, events = 0, single = 0;
+	u_int64 perDev[M27_PLAY_DEV_MAX];
+	u_int16 xorWord;
+	u_int32 d;
+	int dev, ret = 1;
+
+	if (MapFile(fileName, &pf))
+		return(1);
+
+	memset(perDev, 0, sizeof(perDev));
+	p   = pf.data + M27_PLAY_HDR_SIZE;
+	end = pf.data + pf.size;
+
+	while (p < end) {
+		if (*p & M27_PLAY_SINGLE)
+			single++;
+		if (Decode(&p, end, &delta, &dev, &xorWord) ||
+			(u_int32)dev >= pf.devices) {
+			printf("*** record %llu: corrupt\n", (unsigned long long)events);
+			goto CLEANUP;
+		}
+		tick += delta;
+		perDev[dev]++;
+		events++;
+	}
+
+	printf("file       : %s (%llu bytes)\n", fileName,
+		   (unsigned long long)pf.size);
+	printf("tick       : %u ns\n", pf.tickNs);
+	printf("duration   : %.6f s\n", (double)tick * pf.tickNs / 1e9);
+	printf("records    : %llu (%llu single channel, %.2f bytes/record)\n",
+		   (unsigned long long)events, (unsigned long long)single,
+		   events ? (double)(pf.size - M27_PLAY_HDR_SIZE) / events : 0.0);
+	for (d=0; d<pf.devices; d++)
+		printf("device %-3u : %llu records\n", d,
+			   (unsigned long long)perDev[d]);
+
+	if (events != pf.events || tick != pf.duration)
+		printf("*** header mismatch: %llu records, %llu ticks\n",
+			   (unsigned long long)pf.events,
+			   (unsigned long long)pf.duration);
+	else
+		ret = 0;
+
+CLEANUP:
+	UnmapFile(&pf);
+	return(ret);
+}
+
+/*********************************** Play ***********************************
+ *
+ *  Description: Play schedule file
+ *
+ *               Record times are relative to the start time (now +
+ *               start delay). A record is applied immediately if its
+ *               deadline has passed, the schedule is never stretched.
+ *
+ *               A pre-scan checks all records and collects the channels
+ *               driven per device. Only these channels are reset before
+ *               the start, so other users of the devices are not
+ *               disturbed.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: fileName	schedule file
+ *               device		device names (index = device in file)
+ *               devNbr		nr of device names
+ *               lateUs		late threshold [us]
+ *               startMs	start delay [ms]
+ *  Output.....: return	    0 | 1 (error)
+ *  Globals....: -
+ ****************************************************************************/
+static int Play(char *fileName, char **device, int devNbr, u_int32 lateUs,
+				u_int32 startMs)
+{
+	PLAY_FILE pf;
+	MDIS_PATH path[M27_PLAY_DEV_MAX];
+	u_int16 word[M27_PLAY_DEV_MAX], used[M27_PLAY_DEV_MAX], xorWord;
+	M27_CMD cmd;
+	M_SG_BLOCK blk;
+	const u_int8 *p, *end;
+	u_int64 start, deadline, now, late, delta, tick = 0;
+	u_int64 events = 0, lateNbr = 0, lateMax = 0, lateSum = 0;
+	int d, dev, opened = 0, ret = 1;
+
+	if (MapFile(fileName, &pf))
+		return(1);
+
+	if ((u_int32)devNbr < pf.devices) {
+		printf("*** schedule needs %u devices\n", pf.devices);
+		goto CLEANUP;
+	}
+
+	/*--------------------+
+    |  pre-scan records   |
+    +--------------------*/
+	memset(used, 0, sizeof(used));
+	p   = pf.data + M27_PLAY_HDR_SIZE;
+	end = pf.data + pf.size;
+
+	while (p < end) {
+		if (Decode(&p, end, &delta, &dev, &xorWord) ||
+			(u_int32)dev >= pf.devices) {
+			printf("*** record %llu: corrupt\n", (unsigned long long)events);
+			goto CLEANUP;
+		}
+		used[dev] |= xorWord;
+		events++;
+	}
+	events = 0;
+
+	/*--------------------+
+    |  open devices       |
+    +--------------------*/
+	for (d=0; d<devNbr; d++, opened++) {
+		if ((path[d] = M_open(device[d])) < 0) {
+			PrintError("open");
+			goto CLEANUP;
+		}
+
+		/* driven channels off */
+		word[d] = 0;
+		if (used[d] && M_setstat(path[d], M27_CLR_MASK, used[d]) < 0) {
+			PrintError("init");
+			opened++;
+			goto CLEANUP;
+		}
+	}
+
+	/*--------------------+
+    |  stream records     |
+    +--------------------*/
+	p     = pf.data + M27_PLAY_HDR_SIZE;
+	end   = pf.data + pf.size;
+	start = TimeNs() + (u_int64)startMs * 1000000;
+
+	/* records were checked by the pre-scan */
+	while (p < end) {
+		Decode(&p, end, &delta, &dev, &xorWord);
+
+		tick += delta;
+		deadline = start + tick * pf.tickNs;
+
+		if ((now = TimeNs()) < deadline) {
+			SleepUntil(deadline);
+			now = TimeNs();
+		}
+
+		/* write the changed channels only */
+		word[dev] ^= xorWord;
+		if (M_setstat(path[dev], M27_WRITE_MASKED,
+					  M27_MASKED(xorWord, word[dev])) < 0) {
+			PrintError("setstat");
+			goto CLEANUP;
+		}
+
+		late = now > deadline ? now - deadline : 0;
+		lateSum += late;
+		if (late > lateMax)
+			lateMax = late;
+		if (late > (u_int64)lateUs * 1000)
+			lateNbr++;
+		events++;
+	}
+
+	/*--------------------+
+    |  report             |
+    +--------------------*/
+	now = TimeNs();
+	printf("records    : %llu in %.3f s\n", (unsigned long long)events,
+		   (double)(now - start) / 1e9);
+	printf("late       : %llu (> %u us)\n", (unsigned long long)lateNbr,
+		   lateUs);
+	printf("lateness   : avg %.1f us, max %.1f us\n",
+		   events ? (double)lateSum / events / 1000.0 : 0.0,
+		   (double)lateMax / 1000.0);
+
+	for (d=0; d<devNbr; d++) {
+		memset(&cmd, 0, sizeof(cmd));
+		cmd.op   = M27_CMD_READ;
+		blk.data = &cmd;
+		blk.size = sizeof(cmd);
+		if (M_getstat(path[d], M27_BLK_CMDLIST, (int32*)&blk) < 0) {
+			PrintError("getstat");
+			goto CLEANUP;
+		}
+		printf("device %-3d : 0x%04x (%s)\n", d, (u_int16)cmd.result,
+			   device[d]);
+	}
+	ret = 0;
+
+CLEANUP:
+	for (d=0; d<opened; d++)
+		M_close(path[d]);
+	UnmapFile(&pf);
+	return(ret);
+}
+
+/********************************* MapFile **********************************
+ *
+ *  Description: Map schedule file into memory and check header
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: fileName	schedule file
+ *               pf			file descriptor to fill
+ *  Output.....: return	    0 | 1 (error, message printed)
+ *  Globals....: -
+ ****************************************************************************/
+static int MapFile(char *fileName, PLAY_FILE *pf)
+{
+	const u_int8 *h;
+#ifdef LINUX
+	struct stat st;
+	void *addr;
+	int fd;
+
+	memset(pf, 0, sizeof(*pf));
+
+	if ((fd = open(fileName, O_RDONLY)) < 0 || fstat(fd, &st) < 0) {
+		printf("*** can't open %s\n", fileName);
+		if (fd >= 0)
+			close(fd);
+		return(1);
+	}
+
+	if (st.st_size < M27_PLAY_HDR_SIZE) {
+		printf("*** %s: not a schedule file\n", fileName);
+		close(fd);
+		return(1);
+	}
+
+	addr = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (addr == MAP_FAILED) {
+		printf("*** can't map %s\n", fileName);
+		return(1);
+	}
+	madvise(addr, st.st_size, MADV_SEQUENTIAL);
+
+	pf->data = (const u_int8*)addr;
+	pf->size = st.st_size;
+#else
+	FILE *fp;
+	u_int8 *buf;
+	long size;
+
+	memset(pf, 0, sizeof(*pf));
+
+	if (!(fp = fopen(fileName, "rb"))) {
+		printf("*** can't open %s\n", fileName);
+		return(1);
+	}
+
+	if (fseek(fp, 0, SEEK_END) || (size = ftell(fp)) < M27_PLAY_HDR_SIZE ||
+		fseek(fp, 0, SEEK_SET) || !(buf = (u_int8*)malloc(size)) ) {
+		printf("*** %s: not a schedule file\n", fileName);
+		fclose(fp);
+		return(1);
+	}
+
+	if (fread(buf, size, 1, fp) != 1) {
+		printf("*** can't read %s\n", fileName);
+		free(buf);
+		fclose(fp);
+		return(1);
+	}
+	fclose(fp);
+
+	pf->data = buf;
+	pf->size = size;
+#endif
+
+	h = pf->data;
+	pf->devices  = (u_int32)GetLe(&h[M27_PLAY_OFF_DEV], 2);
+	pf->tickNs   = (u_int32)GetLe(&h[M27_PLAY_OFF_TICK], 4);
+	pf->events   = GetLe(&h[M27_PLAY_OFF_EVENTS], 8);
+	pf->duration = GetLe(&h[M27_PLAY_OFF_DUR], 8);
+
+	if (GetLe(&h[M27_PLAY_OFF_MAGIC], 4) != M27_PLAY_MAGIC ||
+		GetLe(&h[M27_PLAY_OFF_VER], 2) != M27_PLAY_VERSION ||
+		pf->devices == 0 || pf->devices > M27_PLAY_DEV_MAX ||
+		pf->tickNs == 0) {
+		printf("*** %s: not a schedule file (or wrong version)\n", fileName);
+		UnmapFile(pf);
+		return(1);
+	}
+
+	return(0);
+}
+
+/******************************** UnmapFile *********************************
+ *
+ *  Description: Release schedule file
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: pf			mapped file
+ *  Output.....: -
+ *  Globals....: -
+ ****************************************************************************/
+static void UnmapFile(PLAY_FILE *pf)
+{
+	if (!pf->data)
+		return;
+#ifdef LINUX
+	munmap((void*)pf->data, pf->size);
+#else
+	free((void*)pf->data);
+#endif
+	pf->data = NULL;
+}
+
+/********************************** Decode **********************************
+ *
+ *  Description: Decode one record
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: pp			record pointer
+ *               end		end of data
+ *  Output.....: pp			next record
+ *               delta		ticks since previous record
+ *               dev		device index
+ *               xorWord	changed channels
+ *               return	    0 | -1 (truncated or corrupt)
+ *  Globals....: -
+ ****************************************************************************/
+static int Decode(const u_int8 **pp, const u_int8 *end, u_int64 *delta,
+				  int *dev, u_int16 *xorWord)
+{
+	const u_int8 *p = *pp;
+	u_int64 val = 0;
+	int shift;
+
+	for (shift=0; ; shift+=7) {
+		if (p == end || shift >= 7 * M27_PLAY_VARINT_MAX)
+			return(-1);
+		val |= (u_int64)(*p & 0x7f) << shift;
+		if (!(*p++ & 0x80))
+			break;
+	}
+
+	if (val & M27_PLAY_SINGLE) {
+		if (p == end)
+			return(-1);
+		*dev = *p >> 4;
+		*xorWord = (u_int16)(1 << (*p & 0x0f));
+		p++;
+	}
+	else {
+		if (end - p < 3)
+			return(-1);
+		*dev = p[0];
+		*xorWord = (u_int16)GetLe(&p[1], 2);
+		p += 3;
+	}
+
+	*delta = val >> 1;
+	*pp = p;
+	return(0);
+}
+
+/******************************** PutVarint *********************************
+ *
+ *  Description: Write varint
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: fp			output file
+ *               val		value
+ *  Output.....: return	    0 | -1 (error)
+ *  Globals....: -
+ ****************************************************************************/
+static int PutVarint(FILE *fp, u_int64 val)
+{
+	u_int8 buf[M27_PLAY_VARINT_MAX];
+	int n = 0;
+
+	do {
+		buf[n] = (u_int8)(val & 0x7f);
+		val >>= 7;
+		if (val)
+			buf[n] |= 0x80;
+		n++;
+	} while (val);
+
+	return( fwrite(buf, n, 1, fp) == 1 ? 0 : -1 );
+}
+
+/********************************** PutLe ***********************************
+ *
+ *  Description: Store little endian value
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: p			destination
+ *               val		value
+ *               size		size [bytes]
+ *  Output.....: -
+ *  Globals....: -
+ ****************************************************************************/
+static void PutLe(u_int8 *p, u_int64 val, int size)
+{
+	while (size--) {
+		*p++ = (u_int8)val;
+		val >>= 8;
+	}
+}
+
+/********************************** GetLe ***********************************
+ *
+ *  Description: Load little endian value
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: p			source
+ *               size		size [bytes]
+ *  Output.....: return	    value
+ *  Globals....: -
+ ****************************************************************************/
+static u_int64 GetLe(const u_int8 *p, int size)
+{
+	u_int64 val = 0;
+
+	while (size--)
+		val = (val << 8) | p[size];
+
+	return(val);
+}
+
+/******************************** SleepUntil ********************************
+ *
+ *  Description: Sleep until absolute time
+ *
+ *               Without CLOCK_MONOTONIC, sleeps the whole ms until the
+ *               deadline.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: ns			deadline (see TimeNs) [ns]
+ *  Output.....: -
+ *  Globals....: -
+ ****************************************************************************/
+static void SleepUntil(u_int64 ns)
+{
+#ifdef LINUX
+	struct timespec ts;
+
+	ts.tv_sec  = (time_t)(ns / 1000000000);
+	ts.tv_nsec = (long)(ns % 1000000000);
+
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL)
+		   == EINTR)
+		;
+#else
+	u_int64 now = TimeNs();
+
+	if (ns > now + 1000000)
+		UOS_Delay((u_int32)((ns - now) / 1000000));
+#endif
+}
+
+/********************************** TimeNs **********************************
+ *
+ *  Description: Get monotonic time [ns]
+ *
+ *               Without CLOCK_MONOTONIC, the ms timer of usr_oss is used.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: -
+ *  Output.....: return     time [ns]
+ *  Globals....: -
+ ****************************************************************************/
+static u_int64 TimeNs(void)
+{
+#ifdef LINUX
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return( (u_int64)ts.tv_sec * 1000000000 + ts.tv_nsec );
+#else
+	return( (u_int64)UOS_MsecTimerGet() * 1000000 );
+#endif
+}
+
+/******************************** PrintError ********************************
+ *
+ *  Description: Print MDIS error message
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: info       info string
+ *  Output.....: -
+ *  Globals....: -
+ ****************************************************************************/
+static void PrintError(char *info)
+{
+	printf("*** can't %s: %s\n", info, M_errstring(UOS_ErrnoGet()));
+}
@@ -8,8 +8,17 @@
  *
  *  Description: Universal tool for read/write M27 channels
  *
+ *               With -f=<file> the path is kept open and commands are
+ *               read line by line from the file or stdin (script mode).
+ *
+ *               The toggle mode (-t) writes the channels with a fixed
+ *               period (-p, 0=as fast as possible) and reports the
+ *               achieved toggle rate, the setblock latency and the
+ *               missed deadlines.
+ *
  *     Required: libraries: mdis_api, usr_oss, usr_utl
- *     Switches: -
+ *     Switches: LINUX		use CLOCK_MONOTONIC (ns) for the toggle
+ *                          statistics, otherwise the ms timer of usr_oss
  *
  *---------------------------------------------------------------------------
  * Copyright 1998-2019, MEN Mikro Elektronik GmbH
@@ -32,10 +41,14 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#ifdef LINUX
+#	include <time.h>
+#endif
 #include <MEN/men_typs.h>
 #include <MEN/usr_oss.h>
 #include <MEN/usr_utl.h>
 #include <MEN/mdis_api.h>
+#include <MEN/mdis_err.h>
 #include <MEN/m27_drv.h>
 
 static const char IdentString[]=MENT_XSTR(MAK_REVISION);
@@ -44,12 +57,21 @@ static const char IdentString[]=MENT_XSTR(MAK_REVISION);
 |   DEFINES                             |
 +--------------------------------------*/
 #define CH_NUMBER	16		/* nr of device channels */
+#define LINE_MAX_LEN	256		/* max. script line length */
+#define SLEEP_MIN_US	2000	/* shorter waits are busy-waited [us] */
 
 /*--------------------------------------+
 |   PROTOTYPES                          |
 +--------------------------------------*/
 static void usage(void);
 static void PrintError(char *info);
+static int Script(MDIS_PATH path, char *file);
+static int ScriptCmd(MDIS_PATH path, char *line);
+static int ScriptNum(char *arg, int32 *valueP);
+static int Toggle(MDIS_PATH path, u_int8 *outbuf, int32 size,
+				  u_int32 periodUs, u_int32 count, int quiet);
+static void PrintStates(u_int8 *buf, int32 last);
+static u_int64 TimeNs(void);
 
 /********************************* usage ************************************
  *
@@ -75,6 +97,16 @@ void usage(void)
 	printf("                                       -> set   ch1\n");
 	printf("                                       -> set   ch2\n");
 	printf("  -t (requires option -S) : toggle specified channels    [none]\n");
+	printf("  -p=<us>        toggle period (0=no delay)              [1000000]\n");
+	printf("  -n=<count>     nr of toggles (0=until key pressed)     [0]\n");
+	printf("  -q             quiet: don't print toggled states       [no]\n");
+	printf("  -f=<file>      script   : execute commands from file   [none]\n");
+	printf("                            (- = stdin), one per line:\n");
+	printf("                            set <chan>, reset <chan>, get <chan>,\n");
+	printf("                            setblock <string>, getblock <chan>,\n");
+	printf("                            sleep <ms>, quit\n");
+	printf("                            each command prints one line:\n");
+	printf("                            ok [<result>] | err <code> <text>\n");
 	printf("  Note: If you specify only the device name, the path will be held open.\n");
 	printf("\n");
 	printf("Copyright 1998-2019, MEN Mikro Elektronik GmbH\n%s\n", IdentString);
@@ -95,15 +127,16 @@ char *argv[];
 {
     MDIS_PATH path;
 	int32	value, gotsize, n, ch;
-	int8	get, set, reset, getblk, setblk, toggle, hold=0;
+	int8	get, set, reset, getblk, setblk, toggle, quiet, hold=0;
+	u_int32	periodUs, count;
 	u_int8  inbuf[20], outbuf[20];
-	char	c, *device, *str, *ptr, *errstr;
+	char	c, *device, *str, *ptr, *errstr, *script;
 	char	buf[40];
 
 	/*--------------------+
     |  check arguments    |
     +--------------------*/
-	if ((errstr = UTL_ILLIOPT("g=s=r=G=S=t?", buf))) {	/* check args */
+	if ((errstr = UTL_ILLIOPT("g=s=r=G=S=tp=n=qf=?", buf))) {	/* check args */
 		printf("*** %s\n", errstr);
 		return(1);
 	}
@@ -131,6 +164,10 @@ char *argv[];
 	set     = ((str = UTL_TSTOPT("s=")) ? atoi(str) : -1);
 	reset   = ((str = UTL_TSTOPT("r=")) ? atoi(str) : -1);
 	getblk  = ((str = UTL_TSTOPT("G=")) ? atoi(str) : -1);
+	script  = UTL_TSTOPT("f=");
+	periodUs = ((str = UTL_TSTOPT("p=")) ? atoi(str) : 1000000);
+	count   = ((str = UTL_TSTOPT("n=")) ? atoi(str) : 0);
+	quiet   = (UTL_TSTOPT("q") ? 1 : 0);
 	setblk  = -1;
 	
 	if ( (str = UTL_TSTOPT("S=")) ) {
@@ -156,6 +193,18 @@ char *argv[];
 		return(1);
 	}
 
+	/*--------------------+
+    |  script mode        |
+    +--------------------*/
+	if (script) {
+		n = Script(path, script);
+
+		if (M_close(path) < 0)
+			PrintError("close");
+
+		return(n ? 1 : 0);
+	}
+
 	/*--------------------+
     |  set                |
     +--------------------*/
@@ -257,54 +306,9 @@ char *argv[];
     |  toggle             |
     +--------------------*/
 	if (toggle) {
-		printf("toggle all channels - press any key to abort\n" );
-
-		/* build inverse */
-		for (ch=0; ch<CH_NUMBER; ch++)
-			inbuf[ch] = ( outbuf[ch] ? 0 : 1 );  
-
-		printf("channel:   00 01 02 03 04 05 06 07 08 09 10 11 12 13 14 15\n");
-
-		/* endless loop */
-		do {
-			printf("state:     ");
-			for (ch=0; ch<CH_NUMBER; ch++) {
-				if (ch <= setblk)
-					printf("%s", (outbuf[ch] ? " S ":" R "));
-				else
-					printf(" - ");
-			}
-			printf("\n");
-
-			/* invert all channels */
-			if ((gotsize = M_setblock(path, outbuf, setblk+1)) < 0) {
-				PrintError("setblock");
-				goto abort;
-			}
-
-			/* delay 1000ms */
-			UOS_Delay(1000);
-
-			printf("state:     ");
-			for (ch=0; ch<CH_NUMBER; ch++) {
-				if (ch <= setblk)
-					printf("%s", (inbuf[ch] ? " S ":" R "));
-				else
-					printf(" - ");
-			}
-			printf("\n");
-
-			/* set all channels */
-			if ((gotsize = M_setblock(path, inbuf, setblk+1)) < 0) {
-				PrintError("setblock");
-				goto abort;
-			}
-
-			/* delay 1000ms */
-			UOS_Delay(1000);
-
-		} while( UOS_KeyPressed() == -1 );
-
+		if (Toggle(path, outbuf, setblk+1, periodUs, count, quiet))
+			goto abort;
+		hold = 0;
 	}
 
 	if ( hold || (argc < 3) ) {
@@ -340,3 +344,331 @@ void PrintError(char *info)
 
 
 
+
+/********************************* Script ***********************************
+ *
+ *  Description: Execute script commands from file or stdin
+ *
+ *               Stdout is line buffered, so each result line can be
+ *               read by the controlling process as soon as it is done.
+ *               Empty lines and lines starting with '#' are ignored.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: path	device path
+ *               file	script file name ("-" = stdin)
+ *  Output.....: return	nr of failed commands
+ *  Globals....: -
+ ****************************************************************************/
+static int Script(MDIS_PATH path, char *file)
+{
+	FILE	*fp;
+	char	line[LINE_MAX_LEN], *p;
+	int		rv, fails=0;
+
+	if (strcmp(file, "-") == 0)
+		fp = stdin;
+	else if ((fp = fopen(file, "r")) == NULL) {
+		printf("*** can't open %s\n", file);
+		return(1);
+	}
+
+	setvbuf(stdout, NULL, _IOLBF, 0);
+
+	while (fgets(line, sizeof(line), fp)) {
+		/* skip leading blanks, comments and empty lines */
+		for (p=line; (*p == ' ') || (*p == '\t'); p++)
+			;
+		if ((*p == '#') || (*p == '\n') || (*p == '\r') || (*p == '\0'))
+			continue;
+
+		if ((rv = ScriptCmd(path, p)) < 0)
+			break;						/* quit */
+		fails += rv;
+	}
+
+	if (fp != stdin)
+		fclose(fp);
+
+	return(fails);
+}
+
+/******************************** ScriptCmd *********************************
+ *
+ *  Description: Execute one script command and print its result line
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: path	device path
+ *               line	command line
+ *  Output.....: return	0=ok, 1=failed, -1=quit
+ *  Globals....: -
+ ****************************************************************************/
+static int ScriptCmd(MDIS_PATH path, char *line)
+{
+	char	cmd[LINE_MAX_LEN], arg[LINE_MAX_LEN];
+	u_int8	blkbuf[CH_NUMBER];
+	int32	value, n, argNbr;
+
+	argNbr = sscanf(line, "%s %s", cmd, arg);
+
+	if (strcmp(cmd, "quit") == 0)
+		return(-1);
+
+	if (argNbr != 2)
+		goto SYNTAX;
+
+	/*--------------------+
+    |  set/reset/get      |
+    +--------------------*/
+	if ( (strcmp(cmd, "set") == 0) || (strcmp(cmd, "reset") == 0) ||
+		 (strcmp(cmd, "get") == 0) ) {
+		if (ScriptNum(arg, &value))
+			goto SYNTAX;
+		if (M_setstat(path, M_MK_CH_CURRENT, value) < 0)
+			goto ERR;
+
+		if (cmd[0] == 'g') {
+			if (M_read(path, &value) < 0)
+				goto ERR;
+			printf("ok %d\n", (int)value);
+			return(0);
+		}
+
+		if (M_write(path, (cmd[0] == 's') ? 1 : 0) < 0)
+			goto ERR;
+	}
+	/*--------------------+
+    |  setblock           |
+    +--------------------*/
+	else if (strcmp(cmd, "setblock") == 0) {
+		for (n=0; arg[n]; n++) {
+			if ((n == CH_NUMBER) || ((arg[n] != 's') && (arg[n] != 'r')))
+				goto SYNTAX;
+			blkbuf[n] = (arg[n] == 's') ? 1 : 0;
+		}
+
+		if (M_setblock(path, blkbuf, n) < 0)
+			goto ERR;
+	}
+	/*--------------------+
+    |  getblock           |
+    +--------------------*/
+	else if (strcmp(cmd, "getblock") == 0) {
+		if (ScriptNum(arg, &n) || (n >= CH_NUMBER))
+			goto SYNTAX;
+		n++;
+
+		if (M_getblock(path, blkbuf, n) < 0)
+			goto ERR;
+
+		printf("ok ");
+		for (value=0; value<n; value++)
+			printf("%c", blkbuf[value] ? 's' : 'r');
+		printf("\n");
+		return(0);
+	}
+	/*--------------------+
+    |  sleep              |
+    +--------------------*/
+	else if (strcmp(cmd, "sleep") == 0) {
+		if (ScriptNum(arg, &value))
+			goto SYNTAX;
+		UOS_Delay(value);
+	}
+	else
+		goto SYNTAX;
+
+	printf("ok\n");
+	return(0);
+
+ ERR:
+	printf("err 0x%04x %s\n", (int)UOS_ErrnoGet(),
+		   M_errstring(UOS_ErrnoGet()));
+	return(1);
+
+ SYNTAX:
+	printf("err 0x%04x syntax\n", ERR_MK_ILL_PARAM);
+	return(1);
+}
+
+/******************************** ScriptNum *********************************
+ *
+ *  Description: Convert a script argument to a number
+ *
+ *               The whole argument must be a decimal number >= 0.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: arg	argument string
+ *  Output.....: valueP	number
+ *               return	0=ok, 1=syntax error
+ *  Globals....: -
+ ****************************************************************************/
+static int ScriptNum(char *arg, int32 *valueP)
+{
+	char	*end;
+	long	value;
+
+	value = strtol(arg, &end, 10);
+	if ((end == arg) || (*end != '\0') || (value < 0) || (value > 0x7fffffff))
+		return(1);
+
+	*valueP = (int32)value;
+	return(0);
+}
+
+/********************************* Toggle ***********************************
+ *
+ *  Description: Toggle channels with a fixed period and print statistics
+ *
+ *               Each iteration writes the channels (alternately 'outbuf'
+ *               and its inverse) with one setblock. Deadlines are
+ *               absolute (start + n * period). An iteration misses its
+ *               deadline if the write isn't done before the next one.
+ *               Waits below SLEEP_MIN_US are busy-waited.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: path		device path
+ *               outbuf		channel states (first write)
+ *               size		nr of channels
+ *               periodUs	toggle period [us] (0=no delay)
+ *               count		nr of toggles (0=until key pressed)
+ *               quiet		don't print the states
+ *  Output.....: return		0 | -1 (error)
+ *  Globals....: -
+ ****************************************************************************/
+static int Toggle(
+	MDIS_PATH path,
+	u_int8 *outbuf,
+	int32 size,
+	u_int32 periodUs,
+	u_int32 count,
+	int quiet)
+{
+	u_int8	inbuf[CH_NUMBER], *buf;
+	u_int64	start, deadline, t0, t1, lat, sum=0, late, maxLate=0;
+	u_int64	latMin=(u_int64)-1, latMax=0, elapsed;
+	u_int32	n, missed=0;
+	int32	ch;
+
+	/* build inverse */
+	for (ch=0; ch<size; ch++)
+		inbuf[ch] = ( outbuf[ch] ? 0 : 1 );
+
+	printf("toggle channel 0..%d, period %u us%s\n", (int)size-1,
+		   (unsigned)periodUs,
+		   count ? "" : " - press any key to abort");
+
+	if (!quiet)
+		printf("channel:   00 01 02 03 04 05 06 07 08 09 10 11 12 13 14 15\n");
+
+	start = deadline = TimeNs();
+
+	for (n=0; (count == 0) || (n < count); n++) {
+		buf = (n & 1) ? inbuf : outbuf;
+
+		if (!quiet)
+			PrintStates(buf, size-1);
+
+		t0 = TimeNs();
+		if (M_setblock(path, buf, size) < 0) {
+			PrintError("setblock");
+			return(-1);
+		}
+		t1 = TimeNs();
+
+		lat = t1 - t0;
+		sum += lat;
+		if (lat < latMin)
+			latMin = lat;
+		if (lat > latMax)
+			latMax = lat;
+
+		/* wait for next deadline */
+		if (periodUs) {
+			deadline += (u_int64)periodUs * 1000;
+
+			if (t1 > deadline) {
+				late = t1 - deadline;
+				if (late > maxLate)
+					maxLate = late;
+				missed++;
+			}
+			else {
+				if (deadline - t1 >= (u_int64)SLEEP_MIN_US * 1000)
+					UOS_Delay((u_int32)((deadline - t1) / 1000000) - 1);
+				while (TimeNs() < deadline)
+					;
+			}
+		}
+
+		/* check for key (not on every iteration when running fast) */
+		if ( (count == 0) &&
+			 ((periodUs >= 1000) || ((n & 0x3ff) == 0x3ff)) &&
+			 (UOS_KeyPressed() != -1) ) {
+			n++;
+			break;
+		}
+	}
+
+	elapsed = TimeNs() - start;
+
+	printf("\ntoggles:          %u in %u.%03u ms\n", (unsigned)n,
+		   (unsigned)(elapsed / 1000000), (unsigned)(elapsed / 1000 % 1000));
+	if (elapsed)
+		printf("toggle rate:      %.1f /s (%.1f Hz square wave)\n",
+			   n * 1e9 / elapsed, n * 0.5e9 / elapsed);
+	if (n)
+		printf("setblock [us]:    min %.2f  avg %.2f  max %.2f\n",
+			   latMin / 1e3, sum / 1e3 / n, latMax / 1e3);
+	if (periodUs)
+		printf("missed deadlines: %u (max. late %.2f us)\n",
+			   (unsigned)missed, maxLate / 1e3);
+
+	return(0);
+}
+
+/******************************** PrintStates *******************************
+ *
+ *  Description: Print channel states (S/R) of channel 0..last
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: buf	channel states
+ *               last	last channel
+ *  Output.....: -
+ *  Globals....: -
+ ****************************************************************************/
+static void PrintStates(u_int8 *buf, int32 last)
+{
+	int32 ch;
+
+	printf("state:     ");
+	for (ch=0; ch<CH_NUMBER; ch++) {
+		if (ch <= last)
+			printf("%s", (buf[ch] ? " S ":" R "));
+		else
+			printf(" - ");
+	}
+	printf("\n");
+}
+
+/********************************** TimeNs **********************************
+ *
+ *  Description: Get monotonic time [ns]
+ *
+ *               Without CLOCK_MONOTONIC, the ms timer of usr_oss is used.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: -
+ *  Output.....: return     time [ns]
+ *  Globals....: -
+ ****************************************************************************/
+static u_int64 TimeNs(void)
+{
+#ifdef LINUX
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return( (u_int64)ts.tv_sec * 1000000000 + ts.tv_nsec );
+#else
+	return( (u_int64)UOS_MsecTimerGet() * 1000000 );
+#endif
+}
@@ -30,6 +30,8 @@ MAK_SWITCH=$(SW_PREFIX)$(DEF_REVISION)
 MAK_LIBS=$(LIB_PREFIX)$(MEN_LIB_DIR)/mdis_api$(LIB_SUFFIX)    \
          $(LIB_PREFIX)$(MEN_LIB_DIR)/usr_oss$(LIB_SUFFIX)     \
          $(LIB_PREFIX)$(MEN_LIB_DIR)/usr_utl$(LIB_SUFFIX)     \
+         -lpthread                                            \
+         -lrt                                                 \
 
 MAK_INCL=$(MEN_INC_DIR)/m27_drv.h     \
          $(MEN_INC_DIR)/men_typs.h    \
@@ -0,0 +1,280 @@
+/****************************************************************************
+ ************                                                    ************
+ ************            M 2 7 _ S C H E D B E N C H             ************
+ ************                                                    ************
+ ****************************************************************************
+ *
+ *  Description: Load test for the output scheduler (m27_sched.hpp)
+ *
+ *               Schedules single channel changes with random channel,
+ *               state and device at the given rate for the given time.
+ *               Every millisecond the changes of the next <lead> ms are
+ *               scheduled and the scheduler is run for 1 ms.
+ *
+ *               Reported are the applied changes, the device writes
+ *               (changes on the same tick are merged), and the wake-up
+ *               jitter of the ticks. At the end the output states are
+ *               read back and compared with the last scheduled change
+ *               of each channel.
+ *
+ *     Required: libraries: mdis_api, usr_oss
+ *     Switches: -
+ *
+ *---------------------------------------------------------------------------
+ * Copyright 2026, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include <MEN/men_typs.h>
+#include <MEN/usr_oss.h>
+#include <MEN/mdis_api.h>
+#include <MEN/m27_sched.hpp>
+
+/*--------------------------------------+
+|   DEFINES                             |
++--------------------------------------*/
+#define RATE_DEF	10000		/* default changes/s */
+#define SECS_DEF	5			/* default duration [s] */
+#define TICK_DEF	100			/* default tick [us] */
+#define LEAD_DEF	50			/* default lead time [ms] */
+#define STEP_NS		1000000		/* scheduling step [ns] */
+
+/*--------------------------------------+
+|   PROTOTYPES                          |
++--------------------------------------*/
+static void usage(void);
+static u_int32 OptVal(int argc, char *argv[], const char *opt, u_int32 def);
+static u_int32 Random(void);
+
+/********************************* usage ************************************
+ *
+ *  Description: Print program usage
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: -
+ *  Output.....: -
+ *  Globals....: -
+ ****************************************************************************/
+static void usage(void)
+{
+	printf("Usage:    m27_schedbench [<opts>] <device> [<device>..]\n");
+	printf("Function: Load test for the M27 output scheduler\n");
+	printf("Options:\n");
+	printf("  device         device name(s)                          [none]\n");
+	printf("  -r=<n>         scheduled changes per second            [%d]\n",
+		   RATE_DEF);
+	printf("  -T=<sec>       test duration                           [%d]\n",
+		   SECS_DEF);
+	printf("  -t=<us>        scheduler tick                          [%d]\n",
+		   TICK_DEF);
+	printf("  -l=<ms>        schedule changes <ms> ahead             [%d]\n",
+		   LEAD_DEF);
+	printf("  -R=<prio>      run with SCHED_FIFO <prio>, lock memory [no]\n");
+	printf("\n");
+	printf("Copyright 2026, MEN Mikro Elektronik GmbH\n");
+}
+
+/********************************* main *************************************
+ *
+ *  Description: Program main function
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: argc,argv	argument counter, data ..
+ *  Output.....: return	    success (0) or error (1)
+ *  Globals....: -
+ ****************************************************************************/
+int main(int argc, char *argv[])
+{
+	u_int32 rate, secs, tickUs, leadMs, prio, ndev;
+	u_int64 start, end, step, next, lead, interval;
+	std::vector<m27::Path> path;
+	std::vector<const char*> name;
+	std::vector<u_int16> expect;
+	int n, err, dev, ch, b;
+	bool on, ok = true;
+
+	for (n=1; n<argc; n++)
+		if (strcmp(argv[n], "-?") == 0) {
+			usage();
+			return(1);
+		}
+
+	rate   = OptVal(argc, argv, "-r=", RATE_DEF);
+	secs   = OptVal(argc, argv, "-T=", SECS_DEF);
+	tickUs = OptVal(argc, argv, "-t=", TICK_DEF);
+	leadMs = OptVal(argc, argv, "-l=", LEAD_DEF);
+	prio   = OptVal(argc, argv, "-R=", 0);
+	if (rate == 0)
+		rate = 1;
+
+	try {
+		for (n=1; n<argc; n++)
+			if (*argv[n] != '-') {
+				path.push_back(m27::Path(argv[n]));
+				name.push_back(argv[n]);
+			}
+
+		if ((ndev = (u_int32)path.size()) == 0) {
+			usage();
+			return(1);
+		}
+
+		if (prio && (err = m27::Scheduler::realtime((int)prio)))
+			printf("*** realtime setup failed: %s\n", strerror(err));
+
+		m27::Scheduler sched(tickUs);
+
+		for (n=0; n<(int)ndev; n++) {
+			sched.add(path[n]);
+			path[n].write(m27::Mask());
+			expect.push_back(0);
+		}
+
+		/*--------------------+
+		|  schedule and run   |
+		+--------------------*/
+		interval = 1000000000ULL / rate;
+		lead     = (u_int64)leadMs * 1000000;
+		start    = m27::Scheduler::now();
+		end      = start + (u_int64)secs * 1000000000;
+		next     = start + lead;
+
+		for (step = start + STEP_NS; step <= end + lead; step += STEP_NS) {
+			/* changes of the next 'lead' ms, in time order */
+			for (; next < step + lead && next < end + lead;
+				 next += interval) {
+				dev = (int)(Random() % ndev);
+				ch  = (int)(Random() % m27::CH_NUMBER);
+				on  = Random() & 1;
+
+				if (on)
+					sched.set(next, dev, m27::Channel(ch));
+				else
+					sched.clear(next, dev, m27::Channel(ch));
+
+				expect[dev] = (u_int16)((expect[dev] & ~(1u << ch)) |
+										((on ? 1u : 0u) << ch));
+			}
+
+			sched.run(step);
+		}
+
+		/*--------------------+
+		|  report             |
+		+--------------------*/
+		const m27::SchedStats &st = sched.stats();
+
+		printf("tick        : %u us\n", tickUs);
+		printf("changes     : %llu (%.0f/s)\n",
+			   (unsigned long long)st.events,
+			   (double)st.events / (secs ? secs : 1));
+		printf("writes      : %llu (%.2f changes/write)\n",
+			   (unsigned long long)st.writes,
+			   st.writes ? (double)st.events / st.writes : 0.0);
+		printf("ticks       : %llu (%llu late)\n",
+			   (unsigned long long)st.ticks,
+			   (unsigned long long)st.lateTicks);
+		if (st.ticks)
+			printf("jitter [us] : min %.1f  avg %.1f  max %.1f\n",
+				   st.jitterMinNs / 1000.0,
+				   (double)st.jitterSumNs / st.ticks / 1000.0,
+				   st.jitterMaxNs / 1000.0);
+
+		printf("histogram   :\n");
+		for (b=0; b<m27::SCHED_HIST; b++) {
+			if (!st.hist[b])
+				continue;
+			if (b == 0)
+				printf("       < 1 us %10llu\n",
+					   (unsigned long long)st.hist[b]);
+			else if (b == m27::SCHED_HIST-1)
+				printf("  >= %6u us %10llu\n", 1u << (b-1),
+					   (unsigned long long)st.hist[b]);
+			else
+				printf("  %5u..%-5u %10llu\n", 1u << (b-1),
+					   (1u << b) - 1, (unsigned long long)st.hist[b]);
+		}
+
+		/*--------------------+
+		|  verify             |
+		+--------------------*/
+		for (n=0; n<(int)ndev; n++) {
+			if (path[n].read() != m27::Mask(expect[n])) {
+				printf("*** %s: outputs 0x%04x, expected 0x%04x\n", name[n],
+					   path[n].read().bits(), expect[n]);
+				ok = false;
+			}
+			path[n].write(m27::Mask());
+		}
+		if (sched.pending()) {
+			printf("*** %u changes not applied\n", sched.pending());
+			ok = false;
+		}
+	}
+	catch (const std::exception &e) {
+		printf("*** %s\n", e.what());
+		return(1);
+	}
+
+	printf("%s\n", ok ? "ok" : "FAILED");
+	return(ok ? 0 : 1);
+}
+
+/********************************** OptVal **********************************
+ *
+ *  Description: Get numeric option value
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: argc,argv	argument counter, data ..
+ *               opt		option prefix (e.g. "-r=")
+ *               def		default value
+ *  Output.....: return	    value
+ *  Globals....: -
+ ****************************************************************************/
+static u_int32 OptVal(int argc, char *argv[], const char *opt, u_int32 def)
+{
+	size_t len = strlen(opt);
+	int n;
+
+	for (n=1; n<argc; n++)
+		if (strncmp(argv[n], opt, len) == 0)
+			return (u_int32)strtoul(argv[n] + len, NULL, 0);
+
+	return(def);
+}
+
+/********************************** Random **********************************
+ *
+ *  Description: Pseudo random number (xorshift, fixed seed)
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: -
+ *  Output.....: return	    random number
+ *  Globals....: -
+ ****************************************************************************/
+static u_int32 Random(void)
+{
+	static u_int32 x = 2463534242u;
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	return(x);
+}
@@ -0,0 +1,220 @@
+/***********************  I n c l u d e  -  F i l e  ************************
+ *
+ *         Name: m27.hpp
+ *
+ *  Description: Header-only C++ wrapper for M27/M28/M81 devices
+ *               - m27::Channel   checked channel number (constexpr)
+ *               - m27::Mask      channel mask (std::bitset<16> compatible)
+ *               - m27::Path      RAII device path (move-only)
+ *               - m27::Error     exception with MDIS error code
+ *
+ *               Every Path call maps onto one MDIS call: channel and
+ *               mask updates use the mask setstat codes, staged updates
+ *               M27_STAGE_MASKED, reads use one M27_BLK_CMDLIST read
+ *               command. No call depends on the
+ *               current channel or the block i/o settings of the device.
+ *
+ *               Include after the MDIS headers (men_typs.h, mdis_api.h,
+ *               usr_oss.h).
+ *               Requires C++11.
+ *
+ *     Switches: -
+ *
+ *---------------------------------------------------------------------------
+ * Copyright 2026, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _M27_HPP
+#define _M27_HPP
+
+#include <bitset>
+#include <stdexcept>
+#include <string>
+#include <MEN/m27_drv.h>
+
+namespace m27 {
+
+/*-----------------------------------------+
+|  DEFINES                                 |
++-----------------------------------------*/
+static const int CH_NUMBER = 16;		/* nr of device channels */
+
+/*-----------------------------------------+
+|  Error                                   |
++-----------------------------------------*/
+/* failed MDIS call */
+class Error : public std::runtime_error {
+public:
+	Error(const char *call, int32 code)
+		: std::runtime_error(std::string("m27: ") + call + ": " +
+							 M_errstring(code)),
+		  code_(code) {}
+
+	int32 code() const noexcept { return code_; }	/* MDIS error code */
+
+private:
+	int32 code_;
+};
+
+/*-----------------------------------------+
+|  Channel                                 |
++-----------------------------------------*/
+/* channel number 0..15, checked at compile time if constant */
+class Channel {
+public:
+	constexpr explicit Channel(int ch)
+		: ch_((ch >= 0 && ch < CH_NUMBER) ? ch :
+			  throw std::out_of_range("m27: illegal channel")) {}
+
+	constexpr int number() const noexcept { return ch_; }
+
+private:
+	int ch_;
+};
+
+/*-----------------------------------------+
+|  Mask                                    |
++-----------------------------------------*/
+/* channel mask, bit n = channel n */
+class Mask {
+public:
+	constexpr Mask() noexcept : bits_(0) {}
+	constexpr explicit Mask(u_int16 bits) noexcept : bits_(bits) {}
+	constexpr Mask(Channel ch) noexcept
+		: bits_((u_int16)(1u << ch.number())) {}
+	Mask(const std::bitset<CH_NUMBER> &b) noexcept
+		: bits_((u_int16)b.to_ulong()) {}
+
+	static constexpr Mask all() noexcept { return Mask(0xffff); }
+
+	constexpr u_int16 bits() const noexcept { return bits_; }
+	std::bitset<CH_NUMBER> bitset() const { return bits_; }
+	constexpr bool test(Channel ch) const noexcept
+		{ return (bits_ >> ch.number()) & 1; }
+
+	friend constexpr Mask operator|(Mask a, Mask b) noexcept
+		{ return Mask((u_int16)(a.bits_ | b.bits_)); }
+	friend constexpr Mask operator&(Mask a, Mask b) noexcept
+		{ return Mask((u_int16)(a.bits_ & b.bits_)); }
+	friend constexpr Mask operator^(Mask a, Mask b) noexcept
+		{ return Mask((u_int16)(a.bits_ ^ b.bits_)); }
+	constexpr Mask operator~() const noexcept
+		{ return Mask((u_int16)~bits_); }
+	friend constexpr bool operator==(Mask a, Mask b) noexcept
+		{ return a.bits_ == b.bits_; }
+	friend constexpr bool operator!=(Mask a, Mask b) noexcept
+		{ return a.bits_ != b.bits_; }
+
+private:
+	u_int16 bits_;
+};
+
+/*-----------------------------------------+
+|  Path                                    |
++-----------------------------------------*/
+/* open device path, closed by the destructor */
+class Path {
+public:
+	explicit Path(const char *device) : path_(M_open(device)) {
+		if (path_ < 0)
+			throw Error("M_open", UOS_ErrnoGet());
+	}
+
+	~Path() noexcept {
+		if (path_ >= 0)
+			M_close(path_);
+	}
+
+	Path(Path &&o) noexcept : path_(o.path_) { o.path_ = -1; }
+
+	Path &operator=(Path &&o) noexcept {
+		if (this != &o) {
+			if (path_ >= 0)
+				M_close(path_);
+			path_ = o.path_;
+			o.path_ = -1;
+		}
+		return *this;
+	}
+
+	Path(const Path &) = delete;
+	Path &operator=(const Path &) = delete;
+
+	/* close explicitly (reports errors, unlike the destructor) */
+	void close() {
+		MDIS_PATH p = path_;
+
+		path_ = -1;
+		if (p >= 0 && M_close(p) < 0)
+			throw Error("M_close", UOS_ErrnoGet());
+	}
+
+	MDIS_PATH native_handle() const noexcept { return path_; }
+
+	/* output updates: one setstat each */
+	void set(Mask m)    { setstat(M27_SET_MASK, m.bits()); }
+	void clear(Mask m)  { setstat(M27_CLR_MASK, m.bits()); }
+	void toggle(Mask m) { setstat(M27_TOGGLE_MASK, m.bits()); }
+	void write(Mask mask, Mask value)
+		{ setstat(M27_WRITE_MASKED, M27_MASKED(mask.bits(), value.bits())); }
+	void write(Mask word) { write(Mask::all(), word); }
+	void write(Channel ch, bool on) { on ? set(ch) : clear(ch); }
+
+	/* output state: one command list getstat */
+	Mask read() {
+		M27_CMD cmd = { M27_CMD_READ, 0, 0, 0, 0 };
+		M_SG_BLOCK blk;
+
+		blk.data = &cmd;
+		blk.size = sizeof(cmd);
+		if (M_getstat(path_, M27_BLK_CMDLIST, (int32*)&blk) < 0)
+			throw Error("M_getstat", UOS_ErrnoGet());
+		return Mask((u_int16)cmd.result);
+	}
+	bool read(Channel ch) { return read().test(ch); }
+
+	/* staged updates: written together by commit(), discarded by abort()
+	   (see M27_STAGE_MASKED, the staged changes are shared per device) */
+	void stage(Mask mask, Mask value)
+		{ setstat(M27_STAGE_MASKED, M27_MASKED(mask.bits(), value.bits())); }
+	void stageSet(Mask m)   { stage(m, Mask::all()); }
+	void stageClear(Mask m) { stage(m, Mask()); }
+	void stage(Channel ch, bool on) { on ? stageSet(ch) : stageClear(ch); }
+	Mask staged() { return Mask((u_int16)getstat(M27_STAGED)); }
+	void commit() { setstat(M27_COMMIT, 0); }
+	void abort()  { setstat(M27_ABORT, 0); }
+
+	/* raw status access */
+	void setstat(int32 code, INT32_OR_64 value) {
+		if (M_setstat(path_, code, value) < 0)
+			throw Error("M_setstat", UOS_ErrnoGet());
+	}
+	int32 getstat(int32 code) {
+		int32 value;
+
+		if (M_getstat(path_, code, &value) < 0)
+			throw Error("M_getstat", UOS_ErrnoGet());
+		return value;
+	}
+
+private:
+	MDIS_PATH path_;
+};
+
+} /* namespace m27 */
+
+#endif /* _M27_HPP */
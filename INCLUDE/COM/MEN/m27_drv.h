@@ -39,16 +39,184 @@
 /*-----------------------------------------+
 |  TYPEDEFS                                |
 +-----------------------------------------*/
-/* none */
+/* sequence table entry (M27_BLK_SEQ_TABLE) */
+typedef struct M27_SEQ_ENTRY {
+	u_int32	delta;		/* time since previous entry [ms] */
+	u_int16	word;		/* output word (bit n = channel n) */
+	u_int16	reserved;	/* reserved (set to 0) */
+} M27_SEQ_ENTRY;
+
+/* software pwm timing statistics (M27_BLK_PWM_STATS) */
+typedef struct {
+	u_int32	tickMs;		/* pwm tick [ms] */
+	u_int32	ticks;		/* pwm ticks executed */
+	u_int32	elapsed;	/* time since pwm start [ms] */
+	u_int32	maxLate;	/* max. tick delay (jitter) [ms] */
+	u_int32	late;		/* ticks delayed more than one OSS tick */
+} M27_PWM_STATS;
+
+/* pulse / pulse train (M27_BLK_PULSE) */
+typedef struct {
+	u_int16	mask;		/* channels to pulse (bit n = channel n) */
+	u_int16	reserved;	/* reserved (set to 0) */
+	u_int32	width;		/* pulse width [us] */
+	u_int32	count;		/* nr of pulses (0/1 = single pulse,
+						   max. 0x7fffffff) */
+	u_int32	period;		/* pulse period [us] (count>1 only) */
+} M27_PULSE;
+
+/* entry statistics (M27_BLK_STATS) */
+#define M27_STATS_ENTRIES	6	/* nr of counted entry points */
+#define M27_STATS_BUCKETS	16	/* nr of log2 histogram buckets */
+
+typedef struct {
+	u_int32	calls[M27_STATS_ENTRIES];	/* calls per entry (M27_ENTRY_xxx) */
+	u_int32	regReads;	/* OUTPUT_REG reads */
+	u_int32	regWrites;	/* OUTPUT_REG writes (all sources) */
+	u_int32	redundant;	/* writes skipped, output word unchanged */
+	u_int32	unitNs;		/* histogram time unit [ns] */
+	u_int32	hist[M27_STATS_ENTRIES][M27_STATS_BUCKETS];
+						/* call duration per entry: bucket 0 <1 unit,
+						   bucket n 2^(n-1)..2^n-1 units, last: longer */
+	u_int32	waits;		/* M27_BLK_WAIT_CHANGE calls (not in calls/hist) */
+} M27_STATS;
+
+/* output trace entry (M27_BLK_TRACE) */
+typedef struct M27_TRACE_ENTRY {
+	u_int32	time;		/* timestamp [M27_STATS.unitNs] */
+	u_int16	oldWord;	/* output word before */
+	u_int16	newWord;	/* output word after */
+	u_int16	src;		/* source of the change (M27_SRC_xxx) */
+	u_int16	reserved;	/* reserved (0) */
+} M27_TRACE_ENTRY;
+
+/* init time breakdown (M27_BLK_INIT_TIME) */
+typedef struct {
+	u_int32	unitNs;		/* time unit [ns] */
+	u_int32	desc;		/* descriptor parse [unitNs] */
+	u_int32	idCheck;	/* id prom read and check [unitNs] */
+	u_int32	reset;		/* hardware reset [unitNs] */
+	u_int32	total;		/* whole init [unitNs] */
+} M27_INIT_TIME;
+
+/* command list entry (M27_BLK_CMDLIST) */
+typedef struct {
+	u_int16	op;			/* command (M27_CMD_xxx) */
+	u_int16	mask;		/* channels (bit n = channel n) */
+	u_int32	value;		/* output word or time (see M27_CMD_xxx) */
+	int32	status;		/* out: 0, error code or -1 (not executed) */
+	u_int32	result;		/* out: output word (M27_CMD_READ) */
+} M27_CMD;
+
+/* wait for output change (M27_BLK_WAIT_CHANGE) */
+typedef struct {
+	u_int32	gen;		/* in: last seen generation, out: current one */
+	int32	timeout;	/* in: max. wait [ms] (0=no wait, -1=forever) */
+	u_int16	word;		/* out: output word */
+	u_int16	reserved;	/* reserved (0) */
+} M27_WAIT_CHANGE;
 
 /*-----------------------------------------+
 |  DEFINES                                 |
 +-----------------------------------------*/
 /* M27 specific status codes (STD) */        /* S,G: S=setstat, G=getstat */
-/*#define M27_XXX           M_DEV_OF+0x00 */     /* G,S: xxx */
+#define M27_READBACK        M_DEV_OF+0x00        /* G,S: read outputs from hw */
+#define M27_BLOCK_MODE      M_DEV_OF+0x01        /* G,S: block i/o buffer layout */
+#define M27_SET_MASK        M_DEV_OF+0x02        /*   S: set channels in mask */
+#define M27_CLR_MASK        M_DEV_OF+0x03        /*   S: reset channels in mask */
+#define M27_TOGGLE_MASK     M_DEV_OF+0x04        /*   S: invert channels in mask */
+#define M27_WRITE_MASKED    M_DEV_OF+0x05        /*   S: write value under mask */
+#define M27_BLOCK_START     M_DEV_OF+0x06        /* G,S: block i/o start channel */
+#define M27_SEQ_LOOPS       M_DEV_OF+0x07        /* G,S: sequence loops (0=endless) */
+#define M27_SEQ_START       M_DEV_OF+0x08        /*   S: start sequence */
+#define M27_SEQ_STOP        M_DEV_OF+0x09        /*   S: stop sequence */
+#define M27_SEQ_STATE       M_DEV_OF+0x0a        /* G  : sequence running */
+#define M27_SEQ_STEPS       M_DEV_OF+0x0b        /* G  : sequence steps executed */
+#define M27_SEQ_LATE        M_DEV_OF+0x0c        /* G  : sequence steps played late */
+#define M27_PWM_PERIOD      M_DEV_OF+0x0d        /* G,S: pwm period [ms] (0=off) */
+#define M27_PWM_DUTY        M_DEV_OF+0x0e        /* G,S: pwm duty cycle [1/1000] */
+#define M27_PULSE_ACTIVE    M_DEV_OF+0x0f        /* G,S: pulse active (S: 0=abort) */
+#define M27_STATS_RESET     M_DEV_OF+0x10        /*   S: clear entry statistics */
+#define M27_TRACE           M_DEV_OF+0x11        /* G,S: output trace enable */
+#define M27_TRACE_LOST      M_DEV_OF+0x12        /* G  : trace entries overwritten */
+#define M27_LOCK_MODE       M_DEV_OF+0x13        /* G  : lock mode (descriptor) */
+#define M27_STAGE_MASKED    M_DEV_OF+0x14        /*   S: stage value under mask */
+#define M27_COMMIT          M_DEV_OF+0x15        /*   S: write staged changes */
+#define M27_ABORT           M_DEV_OF+0x16        /*   S: discard staged changes */
+#define M27_STAGED          M_DEV_OF+0x17        /* G  : staged channels (mask) */
+#define M27_GENERATION      M_DEV_OF+0x18        /* G  : output change counter */
+
+/* M27_BLOCK_MODE values */
+#define M27_BLOCK_BYTES     0   /* one byte per channel (default) */
+#define M27_BLOCK_PACKED    1   /* one bit per channel: u_int16 (ch 0..15),
+                                   size 2 */
+
+/* M27_BLOCK_START values */
+#define M27_BLOCK_START_CH0    0   /* start at channel 0 (default) */
+#define M27_BLOCK_START_CURCH  1   /* start at current channel */
+
+/* M27_WRITE_MASKED/M27_STAGE_MASKED value: mask in bits 31..16, value in bits 15..0 */
+#define M27_MASKED(mask,val) \
+	((int32)((((u_int32)(mask) & 0xffff) << 16) | ((u_int32)(val) & 0xffff)))
 
 /* M27 specific status codes (BLK) */          /* S,G: S=setstat, G=getstat */
-/*#define M27_BLK_XXX       M_DEV_BLK_OF+0x00 */  /* G,S: xxx */
+#define M27_BLK_SEQ_TABLE   M_DEV_BLK_OF+0x00     /*   S: load sequence table */
+#define M27_BLK_PWM_STATS   M_DEV_BLK_OF+0x01     /* G  : pwm timing statistics */
+#define M27_BLK_PULSE       M_DEV_BLK_OF+0x02     /*   S: fire pulse (train) */
+#define M27_BLK_STATS       M_DEV_BLK_OF+0x03     /* G  : entry statistics */
+#define M27_BLK_TRACE       M_DEV_BLK_OF+0x04     /* G  : drain output trace */
+#define M27_BLK_INIT_TIME   M_DEV_BLK_OF+0x05     /* G  : init time breakdown */
+#define M27_BLK_CMDLIST     M_DEV_BLK_OF+0x06     /* G  : execute command list */
+#define M27_BLK_WAIT_CHANGE M_DEV_BLK_OF+0x07     /* G  : wait for output change */
+
+/* M27_STATS entry points */
+#define M27_ENTRY_READ      0
+#define M27_ENTRY_WRITE     1
+#define M27_ENTRY_BLKREAD   2
+#define M27_ENTRY_BLKWRITE  3
+#define M27_ENTRY_SETSTAT   4
+#define M27_ENTRY_GETSTAT   5
+
+/* M27_TRACE_ENTRY sources */
+#define M27_SRC_WRITE       1   /* M_write */
+#define M27_SRC_BLKWRITE    2   /* M_setblock */
+#define M27_SRC_SETSTAT     3   /* mask setstat codes */
+#define M27_SRC_SEQ         4   /* sequence engine */
+#define M27_SRC_PWM         5   /* software pwm */
+#define M27_SRC_PULSE       6   /* pulse generator */
+#define M27_SRC_COMMIT      7   /* M27_COMMIT */
+#define M27_SRC_CMDLIST     8   /* M27_BLK_CMDLIST */
+
+/* M27_LOCK_MODE values (descriptor key LOCK_MODE) */
+#define M27_LOCKMODE_CALL   0   /* every call serialized (default) */
+#define M27_LOCKMODE_FAST   1   /* output i/o concurrent, spin lock only */
+#define M27_LOCKMODE_CHAN   2   /* read/write serialized per channel */
+
+/* M27_CMD commands */
+#define M27_CMD_WRITE       1   /* write output word 'value' */
+#define M27_CMD_SET         2   /* set channels in 'mask' */
+#define M27_CMD_CLR         3   /* reset channels in 'mask' */
+#define M27_CMD_TOGGLE      4   /* invert channels in 'mask' */
+#define M27_CMD_MASKED      5   /* write 'value' under 'mask' */
+#define M27_CMD_DELAY_US    6   /* busy-wait 'value' us (max. 1000) */
+#define M27_CMD_SLEEP_MS    7   /* sleep 'value' ms (max. 1000 per list) */
+#define M27_CMD_PULSE       8   /* pulse 'mask', width 'value' us (max. 1000) */
+#define M27_CMD_READ        9   /* read output word into 'result' */
+
+/* descriptor key OUTPUT_INIT values */
+#define M27_OUTINIT_RESET   0   /* reset all channels (default) */
+#define M27_OUTINIT_ADOPT   1   /* adopt current output register */
+#define M27_OUTINIT_VALUE   2   /* write INIT_VALUE */
+
+/* descriptor key OUTPUT_EXIT values */
+#define M27_OUTEXIT_RESET   0   /* reset all channels (default) */
+#define M27_OUTEXIT_LEAVE   1   /* leave outputs untouched */
+
+/* nr of entries in the trace ring buffer */
+#define M27_TRACE_SIZE      1024
+
+/* max. nr of sequence table entries */
+#define M27_SEQ_MAX         4096
 
 /*-----------------------------------------+
 |  PROTOTYPES                              |
@@ -0,0 +1,78 @@
+/***********************  I n c l u d e  -  F i l e  ************************
+ *
+ *         Name: m27_grp.h
+ *
+ *  Description: Header file for the M27 output group library
+ *               - M27GRP types
+ *               - M27GRP function prototypes
+ *
+ *     Switches: -
+ *
+ *---------------------------------------------------------------------------
+ * Copyright 2026, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _M27_GRP_H
+#define _M27_GRP_H
+
+#ifdef __cplusplus
+      extern "C" {
+#endif
+
+/*-----------------------------------------+
+|  DEFINES                                 |
++-----------------------------------------*/
+#define M27GRP_MAX_DEV		32		/* max. nr of devices in a group */
+#define M27GRP_DEV_CH		16		/* nr of channels per device */
+
+/*-----------------------------------------+
+|  TYPEDEFS                                |
++-----------------------------------------*/
+/* group handle (opaque) */
+typedef struct M27GRP_HANDLE M27GRP_HANDLE;
+
+/* commit statistics */
+typedef struct {
+	u_int32	commits;	/* nr of commits */
+	u_int32	writes;		/* nr of device writes issued */
+	u_int32	errors;		/* nr of commits stopped by a failed write */
+	u_int32	lastWrites;	/* devices written by last commit (also failed) */
+	u_int32	lastUs;		/* duration of last commit [us] */
+	u_int32	maxUs;		/* max. duration of a commit [us] */
+	u_int32	lastSkewUs;	/* first to last device write of last commit [us] */
+	u_int32	maxSkewUs;	/* max. skew of a commit [us] */
+} M27GRP_STATS;
+
+/*-----------------------------------------+
+|  PROTOTYPES                              |
++-----------------------------------------*/
+extern int32 M27GRP_Open(char **devices, int32 devNbr, M27GRP_HANDLE **grpP);
+extern int32 M27GRP_Close(M27GRP_HANDLE **grpP);
+extern int32 M27GRP_ChNbr(M27GRP_HANDLE *grp);
+extern int32 M27GRP_Set(M27GRP_HANDLE *grp, int32 ch);
+extern int32 M27GRP_Clear(M27GRP_HANDLE *grp, int32 ch);
+extern int32 M27GRP_WriteMasked(M27GRP_HANDLE *grp, const u_int16 *mask,
+								const u_int16 *value);
+extern int32 M27GRP_Get(M27GRP_HANDLE *grp, u_int16 *image);
+extern int32 M27GRP_Commit(M27GRP_HANDLE *grp);
+extern int32 M27GRP_Stats(M27GRP_HANDLE *grp, M27GRP_STATS *stats);
+
+#ifdef __cplusplus
+      }
+#endif
+
+#endif /* _M27_GRP_H */
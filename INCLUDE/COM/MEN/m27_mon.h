@@ -0,0 +1,117 @@
+/***********************  I n c l u d e  -  F i l e  ************************
+ *
+ *         Name: m27_mon.h
+ *
+ *  Description: Header file for the M27 state monitor (m27_mon)
+ *               - shared memory layout (written by m27_mon)
+ *               - M27MON reader function prototypes
+ *
+ *               m27_mon publishes the output state of M27 devices in a
+ *               POSIX shared memory segment (default M27MON_SHM_DEF).
+ *               Each device slot is written by one thread only and is
+ *               protected by a sequence lock:
+ *
+ *                 writer: seq++ (odd), update slot, seq++ (even)
+ *                 reader: read seq (retry while odd), copy slot,
+ *                         read seq again, retry if it changed
+ *
+ *               Readers neither lock nor enter the kernel. The header
+ *               is valid once 'magic' is set.
+ *
+ *     Switches: -
+ *
+ *---------------------------------------------------------------------------
+ * Copyright 2026, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _M27_MON_H
+#define _M27_MON_H
+
+#ifdef __cplusplus
+      extern "C" {
+#endif
+
+/*-----------------------------------------+
+|  DEFINES                                 |
++-----------------------------------------*/
+#define M27MON_MAGIC		0x4e4f4d4d	/* "MMON" */
+#define M27MON_VERSION		1			/* layout version */
+#define M27MON_SHM_DEF		"/m27_mon"	/* default segment name */
+#define M27MON_MAX_DEV		32			/* max. nr of devices */
+#define M27MON_NAME_LEN		32			/* max. device name length + 1 */
+#define M27MON_SPIN_MAX		1000000		/* max. read retries */
+
+/* M27MON_DEV state */
+#define M27MON_STATE_INIT	0			/* not yet read */
+#define M27MON_STATE_OK		1			/* word is valid */
+#define M27MON_STATE_ERROR	2			/* device error, word is stale */
+#define M27MON_STATE_STOPPED 3			/* m27_mon terminated */
+
+/*-----------------------------------------+
+|  TYPEDEFS                                |
++-----------------------------------------*/
+/* device slot (one cache line) */
+typedef struct {
+	u_int32	seq;		/* sequence lock (odd: update in progress) */
+	u_int16	word;		/* output word */
+	u_int16	state;		/* M27MON_STATE_xxx */
+	u_int32	gen;		/* driver output generation (M27_GENERATION) */
+	u_int32	changes;	/* changes seen since m27_mon start */
+	u_int64	timeNs;		/* time of last change [ns] (CLOCK_MONOTONIC) */
+	u_int64	aliveNs;	/* time of last update [ns] (CLOCK_MONOTONIC) */
+	char	name[M27MON_NAME_LEN];	/* device name */
+} M27MON_DEV;
+
+/* shared memory segment */
+typedef struct {
+	u_int32	magic;		/* M27MON_MAGIC (set when valid) */
+	u_int32	version;	/* M27MON_VERSION */
+	u_int32	devNbr;		/* nr of devices */
+	u_int32	pid;		/* process id of m27_mon */
+	u_int32	aliveMs;	/* update interval without changes [ms] */
+	u_int8	reserved[44];
+	M27MON_DEV dev[M27MON_MAX_DEV];
+} M27MON_SHM;
+
+/* device state snapshot (M27MON_Read) */
+typedef struct {
+	u_int16	word;		/* output word */
+	u_int16	state;		/* M27MON_STATE_xxx */
+	u_int32	gen;		/* driver output generation */
+	u_int32	changes;	/* changes seen since m27_mon start */
+	u_int32	retries;	/* read retries (concurrent updates) */
+	u_int64	timeNs;		/* time of last change [ns] */
+	u_int64	aliveNs;	/* time of last update [ns] */
+} M27MON_STATE;
+
+/* reader handle (opaque) */
+typedef struct M27MON_HANDLE M27MON_HANDLE;
+
+/*-----------------------------------------+
+|  PROTOTYPES                              |
++-----------------------------------------*/
+extern int32 M27MON_Attach(const char *shmName, M27MON_HANDLE **monP);
+extern int32 M27MON_Detach(M27MON_HANDLE **monP);
+extern int32 M27MON_DevNbr(M27MON_HANDLE *mon);
+extern int32 M27MON_Find(M27MON_HANDLE *mon, const char *device);
+extern int32 M27MON_Read(M27MON_HANDLE *mon, int32 idx, M27MON_STATE *st);
+
+#ifdef __cplusplus
+      }
+#endif
+
+#endif /* _M27_MON_H */
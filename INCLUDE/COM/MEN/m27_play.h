@@ -0,0 +1,76 @@
+/***********************  I n c l u d e  -  F i l e  ************************
+ *
+ *         Name: m27_play.h
+ *
+ *  Description: Binary output schedule format for M27 devices (m27_play)
+ *
+ *               All values are little endian.
+ *
+ *               File header (M27_PLAY_HDR_SIZE bytes):
+ *                 offs size
+ *                  0    4   magic     M27_PLAY_MAGIC
+ *                  4    2   version   M27_PLAY_VERSION
+ *                  6    2   devices   nr of devices (1..M27_PLAY_DEV_MAX)
+ *                  8    4   tickNs    time unit of the deltas [ns]
+ *                 12    4   reserved  0
+ *                 16    8   events    nr of records
+ *                 24    8   duration  time of the last record [ticks]
+ *
+ *               Records (one per transition of one device):
+ *                 varint    (delta << 1) | M27_PLAY_SINGLE
+ *                           delta = ticks since the previous record
+ *                 single:   1 byte  (device << 4) | channel
+ *                           the channel changes its state
+ *                 else:     1 byte  device
+ *                           2 bytes xor of the new and the previous word
+ *
+ *               varint: 7 bits per byte, low bits first, bit 7 set in
+ *               all but the last byte (max. M27_PLAY_VARINT_MAX bytes).
+ *               All outputs are off before the first record.
+ *
+ *     Switches: -
+ *
+ *---------------------------------------------------------------------------
+ * Copyright 2026, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _M27_PLAY_H
+#define _M27_PLAY_H
+
+/*-----------------------------------------+
+|  DEFINES                                 |
++-----------------------------------------*/
+#define M27_PLAY_MAGIC		0x5037324d	/* "M27P" */
+#define M27_PLAY_VERSION	1			/* format version */
+#define M27_PLAY_DEV_MAX	16			/* max. nr of devices */
+#define M27_PLAY_CH_NUMBER	16			/* nr of channels per device */
+
+/* file header */
+#define M27_PLAY_HDR_SIZE	32			/* header size [bytes] */
+#define M27_PLAY_OFF_MAGIC	0			/* offsets in header */
+#define M27_PLAY_OFF_VER	4
+#define M27_PLAY_OFF_DEV	6
+#define M27_PLAY_OFF_TICK	8
+#define M27_PLAY_OFF_EVENTS	16
+#define M27_PLAY_OFF_DUR	24
+
+/* records */
+#define M27_PLAY_SINGLE		0x01		/* single channel record */
+#define M27_PLAY_VARINT_MAX	10			/* max. varint size [bytes] */
+#define M27_PLAY_REC_MAX	(M27_PLAY_VARINT_MAX + 3)	/* max. record size */
+
+#endif /* _M27_PLAY_H */
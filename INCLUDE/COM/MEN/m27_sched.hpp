@@ -0,0 +1,483 @@
+/***********************  I n c l u d e  -  F i l e  ************************
+ *
+ *         Name: m27_sched.hpp
+ *
+ *  Description: Header-only C++ output scheduler for M27 devices
+ *               - m27::Scheduler      timed output changes on m27::Path
+ *               - m27::SchedStats     tick jitter statistics
+ *               - m27::Clock          time source (CLOCK_MONOTONIC)
+ *
+ *               Output changes ("write 'value' under 'mask' at time t")
+ *               are kept in a hierarchical timer wheel (4 levels of 256
+ *               slots, level 0 = one tick). All changes of one device
+ *               that fall on the same tick are merged and written with
+ *               one M27_WRITE_MASKED setstat. Changes are never applied
+ *               before their time: they fire on the first tick at or
+ *               after it.
+ *
+ *               run() sleeps with clock_nanosleep (CLOCK_MONOTONIC,
+ *               absolute deadlines) and only wakes up for ticks that
+ *               have changes. Ticks are passed in steps of the lowest
+ *               wheel level that holds changes. A derived Clock can
+ *               replace the time source (e.g. a virtual clock for
+ *               tests). The scheduler is not thread safe: schedule
+ *               from the thread that calls run(), between run() calls.
+ *
+ *               realtime() optionally switches the calling thread to
+ *               SCHED_FIFO and locks all memory.
+ *
+ *               Include after the MDIS headers (men_typs.h, mdis_api.h,
+ *               usr_oss.h). Requires C++11 and POSIX clocks.
+ *
+ *     Switches: -
+ *
+ *---------------------------------------------------------------------------
+ * Copyright 2026, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef _M27_SCHED_HPP
+#define _M27_SCHED_HPP
+
+#include <errno.h>
+#include <time.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <vector>
+#include <MEN/m27.hpp>
+
+namespace m27 {
+
+/*-----------------------------------------+
+|  SchedStats                              |
++-----------------------------------------*/
+static const int SCHED_HIST = 16;		/* nr of jitter histogram buckets */
+
+/* scheduler statistics, jitter = wake-up time - tick deadline */
+struct SchedStats {
+	u_int64	events;				/* changes applied */
+	u_int64	writes;				/* device writes issued */
+	u_int64	ticks;				/* ticks with changes */
+	u_int64	lateTicks;			/* ticks woken up more than one tick late */
+	u_int64	jitterMinNs;		/* min. jitter [ns] */
+	u_int64	jitterMaxNs;		/* max. jitter [ns] */
+	u_int64	jitterSumNs;		/* sum of jitter [ns] (avg = sum/ticks) */
+	u_int64	hist[SCHED_HIST];	/* jitter: bucket 0 <1us,
+								   bucket n 2^(n-1)..2^n-1 us, last: longer */
+};
+
+/*-----------------------------------------+
+|  Clock                                   |
++-----------------------------------------*/
+/* time source of the scheduler [ns] */
+class Clock {
+public:
+	virtual ~Clock() {}
+
+	virtual u_int64 now() noexcept;
+	virtual void sleepUntil(u_int64 timeNs);
+
+	/* CLOCK_MONOTONIC (default of the scheduler) */
+	static Clock &monotonic() {
+		static Clock clock;
+		return clock;
+	}
+};
+
+/*-----------------------------------------+
+|  Scheduler                               |
++-----------------------------------------*/
+class Scheduler {
+public:
+	explicit Scheduler(u_int32 tickUs = 100,
+					   Clock &clock = Clock::monotonic());
+
+	Scheduler(const Scheduler &) = delete;
+	Scheduler &operator=(const Scheduler &) = delete;
+
+	/* current CLOCK_MONOTONIC time [ns] */
+	static u_int64 now() noexcept {
+		struct timespec ts;
+
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		return (u_int64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+	}
+
+	/* SCHED_FIFO with 'prio' and mlockall, return 0 or errno */
+	static int realtime(int prio);
+
+	/* register device (path must outlive the scheduler), return index */
+	int add(Path &path) {
+		dev_.push_back(Dev(&path));
+		return (int)dev_.size() - 1;
+	}
+
+	/* schedule change: write 'value' under 'mask' at 'timeNs' */
+	void at(u_int64 timeNs, int dev, Mask mask, Mask value);
+	void set(u_int64 timeNs, int dev, Channel ch)
+		{ at(timeNs, dev, ch, Mask::all()); }
+	void clear(u_int64 timeNs, int dev, Channel ch)
+		{ at(timeNs, dev, ch, Mask()); }
+
+	/* apply all changes due until 'untilNs', return at 'untilNs' */
+	void run(u_int64 untilNs);
+
+	u_int32 pending() const noexcept { return pending_; }
+	u_int64 tickNs() const noexcept { return tickNs_; }
+	const SchedStats &stats() const noexcept { return stats_; }
+	void resetStats() noexcept;
+
+private:
+	static const int BITS   = 8;				/* bits per level */
+	static const int SLOTS  = 1 << BITS;		/* slots per level */
+	static const int LEVELS = 4;				/* nr of levels */
+	static const int32 NIL  = -1;				/* end of list */
+
+	struct Event {
+		u_int64	tick;			/* expiry [ticks since start] */
+		int32	next;			/* next event in slot / free list */
+		int32	dev;			/* device index */
+		u_int16	mask;			/* channels */
+		u_int16	value;			/* channel states */
+	};
+	struct Slot {
+		int32	head, tail;		/* event list (in schedule order) */
+	};
+	struct Dev {
+		explicit Dev(Path *p) : path(p), mask(0), value(0) {}
+		Path	*path;
+		u_int16	mask;			/* merged changes of current tick */
+		u_int16	value;
+	};
+
+	void insert(int32 e);
+	void cascade(int level);
+	void process(u_int64 wakeNs, u_int64 deadlineNs);
+
+	Clock				*clock_;		/* time source */
+	u_int64				tickNs_;		/* tick [ns] */
+	u_int64				start_;			/* time of tick 0 [ns] */
+	u_int64				cur_;			/* next tick to process */
+	u_int32				pending_;		/* nr of scheduled changes */
+	int32				free_;			/* free event list */
+	std::vector<Event>	pool_;			/* event storage */
+	Slot				wheel_[LEVELS][SLOTS];
+	u_int32				count_[LEVELS];	/* nr of events per level */
+	std::vector<Dev>	dev_;
+	SchedStats			stats_;
+};
+
+/******************************** Scheduler *********************************
+ *
+ *  Description: Create scheduler, tick 0 is now
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: tickUs  tick [us] (resolution of the change times)
+ *               clock   time source (must outlive the scheduler)
+ ****************************************************************************/
+inline Scheduler::Scheduler(u_int32 tickUs, Clock &clock)
+	: clock_(&clock), tickNs_((u_int64)(tickUs ? tickUs : 1) * 1000),
+	  start_(clock.now()), cur_(0), pending_(0), free_(NIL)
+{
+	int l, s;
+
+	for (l=0; l<LEVELS; l++) {
+		for (s=0; s<SLOTS; s++)
+			wheel_[l][s].head = wheel_[l][s].tail = NIL;
+		count_[l] = 0;
+	}
+
+	resetStats();
+}
+
+/********************************* realtime *********************************
+ *
+ *  Description: Switch calling thread to SCHED_FIFO and lock memory
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: prio    SCHED_FIFO priority
+ *  Output.....: return  0 | errno
+ ****************************************************************************/
+inline int Scheduler::realtime(int prio)
+{
+	struct sched_param sp;
+
+	sp.sched_priority = prio;
+	if (sched_setscheduler(0, SCHED_FIFO, &sp) < 0)
+		return errno;
+
+	if (mlockall(MCL_CURRENT | MCL_FUTURE) < 0)
+		return errno;
+
+	return 0;
+}
+
+/******************************** resetStats ********************************
+ *
+ *  Description: Clear statistics
+ *
+ ****************************************************************************/
+inline void Scheduler::resetStats() noexcept
+{
+	int n;
+
+	stats_.events = stats_.writes = stats_.ticks = stats_.lateTicks = 0;
+	stats_.jitterMinNs = (u_int64)-1;
+	stats_.jitterMaxNs = stats_.jitterSumNs = 0;
+	for (n=0; n<SCHED_HIST; n++)
+		stats_.hist[n] = 0;
+}
+
+/************************************ at ************************************
+ *
+ *  Description: Schedule output change
+ *
+ *               Times in the past fire on the next processed tick.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: timeNs  time [ns] (of the scheduler's clock)
+ *               dev     device index (see add())
+ *               mask    channels to change
+ *               value   new channel states (bits in mask)
+ ****************************************************************************/
+inline void Scheduler::at(u_int64 timeNs, int dev, Mask mask, Mask value)
+{
+	u_int64 tick = 0;
+	int32 e;
+
+	if (dev < 0 || dev >= (int)dev_.size())
+		throw std::out_of_range("m27: illegal scheduler device");
+
+	/* first tick at or after timeNs */
+	if (timeNs > start_)
+		tick = (timeNs - start_ + tickNs_ - 1) / tickNs_;
+	if (tick < cur_)
+		tick = cur_;
+
+	if (free_ != NIL) {
+		e = free_;
+		free_ = pool_[e].next;
+	}
+	else {
+		pool_.push_back(Event());
+		e = (int32)pool_.size() - 1;
+	}
+
+	pool_[e].tick  = tick;
+	pool_[e].dev   = dev;
+	pool_[e].mask  = mask.bits();
+	pool_[e].value = value.bits();
+
+	insert(e);
+	pending_++;
+}
+
+/********************************** insert **********************************
+ *
+ *  Description: Append event to the wheel slot of its expiry tick
+ *
+ *               Level n holds the events due in less than 256^(n+1)
+ *               ticks. Events further away are parked in the last
+ *               slot of level 3 and re-inserted when it is cascaded.
+ *
+ ****************************************************************************/
+inline void Scheduler::insert(int32 e)
+{
+	u_int64 tick = pool_[e].tick, delta = tick - cur_;
+	int level;
+	Slot *slot;
+
+	for (level=0; level<LEVELS-1; level++)
+		if (delta < ((u_int64)1 << (BITS * (level+1))))
+			break;
+
+	if (delta >= ((u_int64)1 << (BITS * LEVELS)))
+		tick = cur_ + ((u_int64)1 << (BITS * LEVELS)) - 1;
+
+	slot = &wheel_[level][(tick >> (BITS * level)) & (SLOTS - 1)];
+
+	pool_[e].next = NIL;
+	if (slot->tail == NIL)
+		slot->head = e;
+	else
+		pool_[slot->tail].next = e;
+	slot->tail = e;
+	count_[level]++;
+}
+
+/********************************* cascade **********************************
+ *
+ *  Description: Move the events of the current slot of a level down
+ *
+ ****************************************************************************/
+inline void Scheduler::cascade(int level)
+{
+	Slot *slot = &wheel_[level][(cur_ >> (BITS * level)) & (SLOTS - 1)];
+	int32 e = slot->head, next;
+
+	slot->head = slot->tail = NIL;
+
+	for (; e != NIL; e = next) {
+		next = pool_[e].next;
+		count_[level]--;
+		insert(e);
+	}
+}
+
+/********************************* process **********************************
+ *
+ *  Description: Apply the changes of tick cur_, one write per device
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: wakeNs      wake-up time [ns]
+ *               deadlineNs  tick deadline [ns]
+ ****************************************************************************/
+inline void Scheduler::process(u_int64 wakeNs, u_int64 deadlineNs)
+{
+	Slot *slot = &wheel_[0][cur_ & (SLOTS - 1)];
+	u_int64 jitter = wakeNs > deadlineNs ? wakeNs - deadlineNs : 0;
+	u_int64 us = jitter / 1000;
+	int32 e = slot->head, next;
+	size_t d;
+	int b;
+
+	slot->head = slot->tail = NIL;
+
+	/* merge changes per device (in schedule order) */
+	for (; e != NIL; e = next) {
+		Event &ev = pool_[e];
+		Dev &dv = dev_[ev.dev];
+
+		next = ev.next;
+		dv.value = (u_int16)((dv.value & ~ev.mask) | (ev.value & ev.mask));
+		dv.mask |= ev.mask;
+
+		ev.next = free_;
+		free_ = e;
+		count_[0]--;
+		pending_--;
+		stats_.events++;
+	}
+
+	for (d=0; d<dev_.size(); d++) {
+		if (dev_[d].mask) {
+			dev_[d].path->write(Mask(dev_[d].mask), Mask(dev_[d].value));
+			dev_[d].mask = dev_[d].value = 0;
+			stats_.writes++;
+		}
+	}
+
+	/* jitter statistics */
+	stats_.ticks++;
+	stats_.jitterSumNs += jitter;
+	if (jitter < stats_.jitterMinNs)
+		stats_.jitterMinNs = jitter;
+	if (jitter > stats_.jitterMaxNs)
+		stats_.jitterMaxNs = jitter;
+	if (jitter > tickNs_)
+		stats_.lateTicks++;
+
+	for (b=0; us && b<SCHED_HIST-1; b++)
+		us >>= 1;
+	stats_.hist[b]++;
+}
+
+/*********************************** run ************************************
+ *
+ *  Description: Apply all changes due until 'untilNs'
+ *
+ *               Ticks without changes are passed without sleeping.
+ *               While the lower levels are empty, cur_ jumps to the
+ *               next boundary of the lowest level with changes (or to
+ *               the first tick after 'untilNs'), where the cascade
+ *               happens. Returns when the next tick lies after
+ *               'untilNs', after sleeping until 'untilNs'.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: untilNs  end time [ns] (of the scheduler's clock)
+ ****************************************************************************/
+inline void Scheduler::run(u_int64 untilNs)
+{
+	u_int64 deadline, next, end;
+	int level;
+
+	for (;;) {
+		deadline = start_ + cur_ * tickNs_;
+		if (deadline > untilNs)
+			break;
+
+		/* cascade higher levels at their boundaries */
+		if ((cur_ & (SLOTS - 1)) == 0) {
+			for (level=1; level<LEVELS; level++)
+				if ((cur_ >> (BITS * level)) & (SLOTS - 1))
+					break;
+			if (level == LEVELS)
+				level--;
+			for (; level>=1; level--)
+				cascade(level);
+		}
+
+		if (wheel_[0][cur_ & (SLOTS - 1)].head != NIL) {
+			clock_->sleepUntil(deadline);
+			process(clock_->now(), deadline);
+		}
+
+		cur_++;
+
+		/* skip the ticks of empty levels */
+		for (level=0; level<LEVELS && !count_[level]; level++)
+			;
+		if (level) {
+			next = ((cur_ + ((u_int64)1 << (BITS * level)) - 1) >>
+					(BITS * level)) << (BITS * level);
+			end  = (untilNs - start_) / tickNs_ + 1;
+			cur_ = next < end ? next : end;
+		}
+	}
+
+	clock_->sleepUntil(untilNs);
+}
+
+/*********************************** now ************************************
+ *
+ *  Description: Get current time [ns]
+ *
+ ****************************************************************************/
+inline u_int64 Clock::now() noexcept
+{
+	return Scheduler::now();
+}
+
+/******************************** sleepUntil ********************************
+ *
+ *  Description: Sleep until absolute CLOCK_MONOTONIC time
+ *
+ ****************************************************************************/
+inline void Clock::sleepUntil(u_int64 timeNs)
+{
+	struct timespec ts;
+
+	ts.tv_sec  = (time_t)(timeNs / 1000000000);
+	ts.tv_nsec = (long)(timeNs % 1000000000);
+
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL)
+		   == EINTR)
+		;
+}
+
+} /* namespace m27 */
+
+#endif /* _M27_SCHED_HPP */
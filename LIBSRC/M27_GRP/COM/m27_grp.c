@@ -0,0 +1,383 @@
+/*********************  P r o g r a m  -  M o d u l e ***********************
+ *
+ *         Name: m27_grp.c
+ *      Project: M27 output group library
+ *
+ *  Description: Treat several M27/M28/M81 devices as one wide output image
+ *
+ *               The group holds a staged image with one u_int16 word per
+ *               device (channel n = device n/16, bit n%16). Set/Clear/
+ *               WriteMasked modify the staged image only and mark the
+ *               touched channels. Commit writes the marked channels of
+ *               all devices in one pass, with one M27_WRITE_MASKED each.
+ *
+ *               Channels not touched through the group are never written,
+ *               so other paths and the driver's sequence, PWM and pulse
+ *               engines may share the devices. The device-wide block i/o
+ *               settings are not changed.
+ *
+ *     Required: libraries: mdis_api, usr_oss
+ *     Switches: LINUX		use CLOCK_MONOTONIC for commit timing [us]
+ *
+ *---------------------------------------------------------------------------
+ * Copyright 2026, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#ifdef LINUX
+#	include <time.h>
+#endif
+#include <MEN/men_typs.h>
+#include <MEN/usr_oss.h>
+#include <MEN/mdis_api.h>
+#include <MEN/mdis_err.h>
+#include <MEN/m27_drv.h>
+#include <MEN/m27_grp.h>
+
+/*--------------------------------------+
+|   TYPEDEFS                            |
++--------------------------------------*/
+/* group handle */
+struct M27GRP_HANDLE {
+	int32			devNbr;						/* nr of devices */
+	MDIS_PATH		path[M27GRP_MAX_DEV];		/* device paths */
+	u_int16			staged[M27GRP_MAX_DEV];		/* staged image */
+	u_int16			committed[M27GRP_MAX_DEV];	/* last written image */
+	u_int16			dirty[M27GRP_MAX_DEV];		/* channels to commit */
+	M27GRP_STATS	stats;						/* commit statistics */
+};
+
+/*--------------------------------------+
+|   PROTOTYPES                          |
++--------------------------------------*/
+static u_int32 TimeUs(void);
+
+/******************************* M27GRP_Open ********************************
+ *
+ *  Description: Open all devices of a group
+ *
+ *               The current output word of each device is read with a
+ *               command list (M27_CMD_READ) as initial image, so the
+ *               device-wide block i/o settings stay untouched.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: devices	device names
+ *               devNbr     nr of devices (1..M27GRP_MAX_DEV)
+ *  Output.....: grpP       group handle
+ *               return     success (0) or error (-1, see UOS_ErrnoGet)
+ *  Globals....: -
+ ****************************************************************************/
+int32 M27GRP_Open(char **devices, int32 devNbr, M27GRP_HANDLE **grpP)
+{
+	M27GRP_HANDLE *grp;
+	M27_CMD cmd;
+	M_SG_BLOCK blk;
+	int32 d;
+
+	*grpP = NULL;
+
+	if ((devNbr < 1) || (devNbr > M27GRP_MAX_DEV)) {
+		UOS_ErrnoSet(ERR_MK_ILL_PARAM);
+		return(-1);
+	}
+
+	if ((grp = (M27GRP_HANDLE*)malloc(sizeof(M27GRP_HANDLE))) == NULL) {
+		UOS_ErrnoSet(ERR_OSS_MEM_ALLOC);
+		return(-1);
+	}
+	memset(grp, 0, sizeof(M27GRP_HANDLE));
+
+	for (d=0; d<devNbr; d++) {
+		if ((grp->path[d] = M_open(devices[d])) < 0)
+			goto abort;
+		grp->devNbr++;
+
+		memset(&cmd, 0, sizeof(cmd));
+		cmd.op = M27_CMD_READ;
+		blk.size = sizeof(cmd);
+		blk.data = &cmd;
+
+		if (M_getstat(grp->path[d], M27_BLK_CMDLIST, (int32*)&blk) < 0)
+			goto abort;
+
+		grp->staged[d]    = (u_int16)cmd.result;
+		grp->committed[d] = grp->staged[d];
+	}
+
+	*grpP = grp;
+	return(0);
+
+abort:
+	{
+		u_int32 error = UOS_ErrnoGet();
+
+		M27GRP_Close(&grp);
+		UOS_ErrnoSet(error);
+	}
+	return(-1);
+}
+
+/****************************** M27GRP_Close ********************************
+ *
+ *  Description: Close all devices of a group, free the handle
+ *
+ *               The outputs keep their committed state, uncommitted
+ *               changes are discarded.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: grpP		group handle
+ *  Output.....: grpP       NULL
+ *               return     success (0) or error (-1)
+ *  Globals....: -
+ ****************************************************************************/
+int32 M27GRP_Close(M27GRP_HANDLE **grpP)
+{
+	M27GRP_HANDLE *grp = *grpP;
+	int32 d, ret = 0;
+
+	if (grp == NULL)
+		return(0);
+
+	for (d=0; d<grp->devNbr; d++)
+		if (M_close(grp->path[d]) < 0)
+			ret = -1;
+
+	free(grp);
+	*grpP = NULL;
+
+	return(ret);
+}
+
+/****************************** M27GRP_ChNbr ********************************
+ *
+ *  Description: Get nr of channels of a group
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: grp		group handle
+ *  Output.....: return     nr of channels
+ *  Globals....: -
+ ****************************************************************************/
+int32 M27GRP_ChNbr(M27GRP_HANDLE *grp)
+{
+	return(grp->devNbr * M27GRP_DEV_CH);
+}
+
+/******************************* M27GRP_Set *********************************
+ *
+ *  Description: Set one channel in the staged image
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: grp		group handle
+ *               ch         group channel (0..devNbr*16-1)
+ *  Output.....: return     success (0) or error (-1)
+ *  Globals....: -
+ ****************************************************************************/
+int32 M27GRP_Set(M27GRP_HANDLE *grp, int32 ch)
+{
+	if ((ch < 0) || (ch >= grp->devNbr * M27GRP_DEV_CH)) {
+		UOS_ErrnoSet(ERR_MK_ILL_PARAM);
+		return(-1);
+	}
+
+	grp->staged[ch / M27GRP_DEV_CH] |= (u_int16)(1 << (ch % M27GRP_DEV_CH));
+	grp->dirty[ch / M27GRP_DEV_CH]  |= (u_int16)(1 << (ch % M27GRP_DEV_CH));
+	return(0);
+}
+
+/****************************** M27GRP_Clear ********************************
+ *
+ *  Description: Reset one channel in the staged image
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: grp		group handle
+ *               ch         group channel (0..devNbr*16-1)
+ *  Output.....: return     success (0) or error (-1)
+ *  Globals....: -
+ ****************************************************************************/
+int32 M27GRP_Clear(M27GRP_HANDLE *grp, int32 ch)
+{
+	if ((ch < 0) || (ch >= grp->devNbr * M27GRP_DEV_CH)) {
+		UOS_ErrnoSet(ERR_MK_ILL_PARAM);
+		return(-1);
+	}
+
+	grp->staged[ch / M27GRP_DEV_CH] &= (u_int16)~(1 << (ch % M27GRP_DEV_CH));
+	grp->dirty[ch / M27GRP_DEV_CH]  |= (u_int16)(1 << (ch % M27GRP_DEV_CH));
+	return(0);
+}
+
+/*************************** M27GRP_WriteMasked *****************************
+ *
+ *  Description: Write the staged image under a mask
+ *
+ *               For each device d:
+ *                 staged[d] = (staged[d] & ~mask[d]) | (value[d] & mask[d])
+ *               The channels in mask[d] are committed with the next
+ *               M27GRP_Commit.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: grp		group handle
+ *               mask       channels to write (devNbr words)
+ *               value      new channel states (devNbr words)
+ *  Output.....: return     success (0)
+ *  Globals....: -
+ ****************************************************************************/
+int32 M27GRP_WriteMasked(M27GRP_HANDLE *grp, const u_int16 *mask,
+						 const u_int16 *value)
+{
+	int32 d;
+
+	for (d=0; d<grp->devNbr; d++) {
+		grp->staged[d] = (u_int16)((grp->staged[d] & ~mask[d]) |
+								   (value[d] & mask[d]));
+		grp->dirty[d] |= mask[d];
+	}
+	return(0);
+}
+
+/******************************* M27GRP_Get *********************************
+ *
+ *  Description: Get the staged image
+ *
+ *               Channels written by other paths since M27GRP_Open are
+ *               only seen for channels the group never touched.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: grp		group handle
+ *  Output.....: image      staged image (devNbr words)
+ *               return     success (0)
+ *  Globals....: -
+ ****************************************************************************/
+int32 M27GRP_Get(M27GRP_HANDLE *grp, u_int16 *image)
+{
+	memcpy(image, grp->staged, grp->devNbr * sizeof(u_int16));
+	return(0);
+}
+
+/****************************** M27GRP_Commit *******************************
+ *
+ *  Description: Write the staged changes to the devices
+ *
+ *               Each device with touched channels that differ from the
+ *               last committed state gets one M27_WRITE_MASKED, which
+ *               updates only these channels. Devices without such
+ *               changes are skipped, also if other paths changed their
+ *               outputs since. Duration and skew (first to last device
+ *               write) are recorded in the stats.
+ *
+ *               If a write fails, the pass stops: the devices written so
+ *               far are counted (stats 'lastWrites') and the failed and
+ *               remaining devices keep their changes for the next commit.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: grp		group handle
+ *  Output.....: return     nr of devices written or error (-1)
+ *  Globals....: -
+ ****************************************************************************/
+int32 M27GRP_Commit(M27GRP_HANDLE *grp)
+{
+	M27GRP_STATS *stats = &grp->stats;
+	u_int32 start, first=0, end, error = 0;
+	int32 d, writes=0;
+	u_int16 mask;
+
+	start = TimeUs();
+
+	for (d=0; d<grp->devNbr; d++) {
+		/* touched channels that differ from the last committed state */
+		mask = (u_int16)(grp->dirty[d] &
+						 (grp->staged[d] ^ grp->committed[d]));
+		if (mask == 0) {
+			grp->dirty[d] = 0;
+			continue;
+		}
+
+		if (writes == 0)
+			first = TimeUs();
+
+		if (M_setstat(grp->path[d], M27_WRITE_MASKED,
+					  M27_MASKED(mask, grp->staged[d])) < 0) {
+			error = UOS_ErrnoGet();
+			break;
+		}
+
+		grp->committed[d] = (u_int16)((grp->committed[d] & ~mask) |
+									  (grp->staged[d] & mask));
+		grp->dirty[d] = 0;
+		writes++;
+	}
+
+	end = TimeUs();
+
+	stats->commits++;
+	stats->writes += writes;
+	stats->lastWrites = writes;
+	stats->lastUs  = end - start;
+	stats->lastSkewUs = writes ? end - first : 0;
+	if (stats->lastUs > stats->maxUs)
+		stats->maxUs = stats->lastUs;
+	if (stats->lastSkewUs > stats->maxSkewUs)
+		stats->maxSkewUs = stats->lastSkewUs;
+
+	if (error) {
+		stats->errors++;
+		UOS_ErrnoSet(error);
+		return(-1);
+	}
+
+	return(writes);
+}
+
+/****************************** M27GRP_Stats ********************************
+ *
+ *  Description: Get commit statistics
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: grp		group handle
+ *  Output.....: stats      commit statistics
+ *               return     success (0)
+ *  Globals....: -
+ ****************************************************************************/
+int32 M27GRP_Stats(M27GRP_HANDLE *grp, M27GRP_STATS *stats)
+{
+	*stats = grp->stats;
+	return(0);
+}
+
+/********************************* TimeUs ***********************************
+ *
+ *  Description: Get monotonic time [us]
+ *
+ *               Without CLOCK_MONOTONIC, the ms timer of usr_oss is used.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: -
+ *  Output.....: return     time [us] (wraps)
+ *  Globals....: -
+ ****************************************************************************/
+static u_int32 TimeUs(void)
+{
+#ifdef LINUX
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return( (u_int32)(ts.tv_sec * 1000000 + ts.tv_nsec / 1000) );
+#else
+	return( UOS_MsecTimerGet() * 1000 );
+#endif
+}
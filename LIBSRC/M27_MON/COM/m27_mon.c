@@ -0,0 +1,222 @@
+/*********************  P r o g r a m  -  M o d u l e ***********************
+ *
+ *         Name: m27_mon.c
+ *      Project: M27 state monitor reader library
+ *
+ *  Description: Read the M27 output states published by m27_mon
+ *
+ *               The shared memory segment is mapped read-only. Reading
+ *               a device state is a copy of its slot under the sequence
+ *               lock (see m27_mon.h): no lock, no system call, no MDIS
+ *               path. The handle may be used by several threads.
+ *
+ *     Required: POSIX shared memory (shm_open), GCC __atomic builtins
+ *     Switches: -
+ *
+ *---------------------------------------------------------------------------
+ * Copyright 2026, MEN Mikro Elektronik GmbH
+ ****************************************************************************/
+/*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 2 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <MEN/men_typs.h>
+#include <MEN/usr_oss.h>
+#include <MEN/mdis_err.h>
+#include <MEN/m27_mon.h>
+
+/*--------------------------------------+
+|   TYPEDEFS                            |
++--------------------------------------*/
+/* reader handle */
+struct M27MON_HANDLE {
+	const M27MON_SHM	*shm;		/* mapped segment */
+	u_int32				devNbr;		/* nr of devices */
+};
+
+/****************************** M27MON_Attach *******************************
+ *
+ *  Description: Map the shared memory segment of m27_mon
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: shmName	segment name (NULL: M27MON_SHM_DEF)
+ *  Output.....: monP       reader handle
+ *               return     success (0) or error (-1, see UOS_ErrnoGet)
+ *  Globals....: -
+ ****************************************************************************/
+int32 M27MON_Attach(const char *shmName, M27MON_HANDLE **monP)
+{
+	M27MON_HANDLE *mon;
+	const M27MON_SHM *shm;
+	struct stat st;
+	void *addr;
+	int fd;
+
+	*monP = NULL;
+
+	if ((fd = shm_open(shmName ? shmName : M27MON_SHM_DEF, O_RDONLY, 0)) < 0) {
+		UOS_ErrnoSet(errno);
+		return(-1);
+	}
+
+	if (fstat(fd, &st) < 0 || st.st_size < (off_t)sizeof(M27MON_SHM)) {
+		close(fd);
+		UOS_ErrnoSet(ERR_MK_ILL_PARAM);
+		return(-1);
+	}
+
+	addr = mmap(NULL, sizeof(M27MON_SHM), PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (addr == MAP_FAILED) {
+		UOS_ErrnoSet(errno);
+		return(-1);
+	}
+	shm = (const M27MON_SHM*)addr;
+
+	/* header is valid once magic is set */
+	if (__atomic_load_n(&shm->magic, __ATOMIC_ACQUIRE) != M27MON_MAGIC ||
+		shm->version != M27MON_VERSION || shm->devNbr > M27MON_MAX_DEV) {
+		munmap(addr, sizeof(M27MON_SHM));
+		UOS_ErrnoSet(ERR_MK_ILL_PARAM);
+		return(-1);
+	}
+
+	if ((mon = (M27MON_HANDLE*)malloc(sizeof(M27MON_HANDLE))) == NULL) {
+		munmap(addr, sizeof(M27MON_SHM));
+		UOS_ErrnoSet(ERR_OSS_MEM_ALLOC);
+		return(-1);
+	}
+
+	mon->shm    = shm;
+	mon->devNbr = shm->devNbr;
+
+	*monP = mon;
+	return(0);
+}
+
+/****************************** M27MON_Detach *******************************
+ *
+ *  Description: Unmap the segment, free the handle
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: monP		reader handle
+ *  Output.....: monP       NULL
+ *               return     success (0)
+ *  Globals....: -
+ ****************************************************************************/
+int32 M27MON_Detach(M27MON_HANDLE **monP)
+{
+	M27MON_HANDLE *mon = *monP;
+
+	if (mon == NULL)
+		return(0);
+
+	munmap((void*)mon->shm, sizeof(M27MON_SHM));
+	free(mon);
+	*monP = NULL;
+
+	return(0);
+}
+
+/****************************** M27MON_DevNbr *******************************
+ *
+ *  Description: Get nr of published devices
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: mon		reader handle
+ *  Output.....: return     nr of devices
+ *  Globals....: -
+ ****************************************************************************/
+int32 M27MON_DevNbr(M27MON_HANDLE *mon)
+{
+	return((int32)mon->devNbr);
+}
+
+/******************************* M27MON_Find ********************************
+ *
+ *  Description: Get slot index of a device
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: mon		reader handle
+ *               device     device name (as given to m27_mon)
+ *  Output.....: return     index or error (-1)
+ *  Globals....: -
+ ****************************************************************************/
+int32 M27MON_Find(M27MON_HANDLE *mon, const char *device)
+{
+	u_int32 d;
+
+	for (d=0; d<mon->devNbr; d++)
+		if (strncmp(mon->shm->dev[d].name, device, M27MON_NAME_LEN) == 0)
+			return((int32)d);
+
+	UOS_ErrnoSet(ERR_MK_ILL_PARAM);
+	return(-1);
+}
+
+/******************************* M27MON_Read ********************************
+ *
+ *  Description: Get consistent snapshot of a device state
+ *
+ *               The slot is copied until no update overlapped the copy.
+ *               st->retries counts the repeated copies.
+ *
+ *---------------------------------------------------------------------------
+ *  Input......: mon		reader handle
+ *               idx        slot index (0..M27MON_DevNbr-1)
+ *  Output.....: st         device state
+ *               return     success (0) or error (-1, see UOS_ErrnoGet)
+ *  Globals....: -
+ ****************************************************************************/
+int32 M27MON_Read(M27MON_HANDLE *mon, int32 idx, M27MON_STATE *st)
+{
+	const M27MON_DEV *dev;
+	u_int32 seq, n;
+
+	if ((idx < 0) || ((u_int32)idx >= mon->devNbr)) {
+		UOS_ErrnoSet(ERR_MK_ILL_PARAM);
+		return(-1);
+	}
+	dev = &mon->shm->dev[idx];
+
+	for (n=0; n<M27MON_SPIN_MAX; n++) {
+		seq = __atomic_load_n(&dev->seq, __ATOMIC_ACQUIRE);
+		if (seq & 1)
+			continue;				/* update in progress */
+
+		st->word    = dev->word;
+		st->state   = dev->state;
+		st->gen     = dev->gen;
+		st->changes = dev->changes;
+		st->timeNs  = dev->timeNs;
+		st->aliveNs = dev->aliveNs;
+
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		if (__atomic_load_n(&dev->seq, __ATOMIC_RELAXED) == seq) {
+			st->retries = n;
+			return(0);
+		}
+	}
+
+	/* writer died during an update */
+	UOS_ErrnoSet(ERR_OSS_BUSY_RESOURCE);
+	return(-1);
+}